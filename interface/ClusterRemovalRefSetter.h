@@ -7,6 +7,7 @@
 #include "DataFormats/SiStripCluster/interface/SiStripCluster.h"
 #include "DataFormats/SiPixelCluster/interface/SiPixelCluster.h"
 
+#include "DataFormats/TrackingRecHit/interface/TrackingRecHitFwd.h"
 #include "DataFormats/TrackerRecHit2D/interface/ClusterRemovalInfo.h"
 #include "DataFormats/TrackerRecHit2D/interface/ProjectedSiStripRecHit2D.h"
 #include "DataFormats/TrackerRecHit2D/interface/SiPixelRecHit.h"
@@ -17,20 +18,46 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 
+#include <utility>
+#include <vector>
+
 class ClusterRemovalRefSetter {
 public:
   ClusterRemovalRefSetter(const edm::Event &iEvent, const edm::InputTag& tag) ;
+  /// (old index, new index) of the clusters used by the rekeyed hits, sorted and without duplicates
+  struct IndexMap {
+    std::vector<std::pair<unsigned int, unsigned int> > pixel, strip;
+  };
+
   void reKey(TrackingRecHit *hit) const ;
+  /// Rekeys all the hits of the collection. The type of each hit is determined once and its
+  /// cluster refs are collected; the product IDs of all of them are checked before any is changed,
+  /// then the refs are translated. If indexMap is given, it is filled with the translation used.
+  void reKey(TrackingRecHitCollection &hits, IndexMap *indexMap = 0) const ;
 private:
   typedef OmniClusterRef::ClusterPixelRef ClusterPixelRef;
   typedef OmniClusterRef::ClusterStripRef ClusterStripRef;
   typedef OmniClusterRef::ClusterRegionalRef ClusterRegionalRef;
 
+  /// what has to be rekeyed in a hit (skipHit: invalid hit, or no removal info for its detector)
+  enum HitType { skipHit=0, pixelHit, stripHit2D, stripHit1D, matchedHit, projectedHit, nHitTypes };
+  HitType hitType(const TrackingRecHit &hit) const ;
+  void reKey(TrackingRecHit *hit, HitType type) const ;
+
+  void checkProductIDs(const std::vector<OmniClusterRef*>& refs, const edm::ProductID& expected, const char* what) const ;
+  template <class ClusterRef, class RefProd>
+  static void translate(const std::vector<OmniClusterRef*>& refs, const reco::ClusterRemovalInfo::Indices& indices,
+			const RefProd& oldRefProd, std::vector<std::pair<unsigned int, unsigned int> >* map) ;
+
   void reKeyPixel(OmniClusterRef& clusRef) const ;
   void reKeyStrip(OmniClusterRef& clusRef) const ;
   //void reKeyRegional(OmniClusterRef& clusRef) const ;
 private:
   const reco::ClusterRemovalInfo *cri_;
+  // taken once from the ClusterRemovalInfo
+  bool hasPixel_, hasStrip_;
+  const reco::ClusterRemovalInfo::Indices *pixelIndices_, *stripIndices_;
+  edm::ProductID pixelNewId_, stripNewId_;
 };
 
 #endif
@@ -31,10 +31,16 @@ public:
   /// Constructor
   explicit GsfTrackProducerBase(bool trajectoryInEvent, bool split) :
     TrackProducerBase<reco::GsfTrack>(trajectoryInEvent),
-    useSplitting(split){}
+    useSplitting(split), validateMode_(false){}
 
-  /// Put produced collections in the event
-  virtual void putInEvt(edm::Event&,
+  /// Compare the mode at the vertex with the result of MultiGaussianStateTransform::multiState1D (debugging)
+  void setValidateMode(bool validate) { validateMode_ = validate; }
+
+  /// Put produced collections in the event.
+  /// The trajectories of algoResults are moved into the output (TrajectoryInEvent) or released:
+  /// after the call they are empty, only the tracks of algoResults can still be used.
+  /// Returns the handle of the tracks put, to build Refs to them
+  virtual edm::OrphanHandle<reco::GsfTrackCollection> putInEvt(edm::Event&,
 			const Propagator* prop,
 			const MeasurementTracker* measTk,
 			std::auto_ptr<TrackingRecHitCollection>&,
@@ -59,6 +65,9 @@ private:
   void localParametersFromQpMode (const TrajectoryStateOnSurface tsos,
 				  AlgebraicVector5& parameters,
 				  AlgebraicSymMatrix55& covariance) const;
+  /// recompute the mode of local parameter iv per parameter and warn if it differs
+  void checkMode (const TrajectoryStateOnSurface& tsos, unsigned int iv,
+		  double mode, double variance) const;
   /// position, momentum and estimated deltaP at an intermediate measurement (true if successful)
   bool computeModeAtTM (const TrajectoryMeasurement& tm,
 			reco::GsfTrackExtra::Point& position,
@@ -67,6 +76,7 @@ private:
 
 private:
 bool useSplitting;
+bool validateMode_;
 
 };
 
@@ -12,6 +12,9 @@
 #include "RecoTracker/TrackProducer/interface/TrackProducerBase.h"
 
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+#include "DataFormats/TrackReco/interface/TrackResiduals.h"
+
+#include <string>
 
 class Trajectory;
 
@@ -20,10 +23,20 @@ public:
 
   /// Constructor
   explicit KfTrackProducerBase(bool trajectoryInEvent, bool split) :
-    TrackProducerBase<reco::Track>(trajectoryInEvent),useSplitting(split) {}
+    TrackProducerBase<reco::Track>(trajectoryInEvent),useSplitting(split),tracksOnly_(false),
+    fillResiduals_(true),residualType_(reco::TrackResiduals::X_Y_PULLS) {}
+
+  /// Only the TrackCollection is put in the event: no TrackExtras, hits or trajectories
+  void setTracksOnly(bool tracksOnly) { tracksOnly_ = tracksOnly; }
 
-  /// Put produced collections in the event
-  virtual void putInEvt(edm::Event&,
+  /// Residuals stored in the TrackExtras: "off", "X_Y_RESIDUALS" or "X_Y_PULLS" (the default)
+  void setResiduals(const std::string& type);
+
+  /// Put produced collections in the event.
+  /// The tracks of algoResults are moved into the output and their trajectories are moved into it
+  /// too (TrajectoryInEvent) or released: after the call algoResults must not be used any more.
+  /// Returns the handle of the tracks put, to build Refs to them
+  virtual edm::OrphanHandle<reco::TrackCollection> putInEvt(edm::Event&,
 			const Propagator* prop,
 			const MeasurementTracker* measTk,
 			std::auto_ptr<TrackingRecHitCollection>&,
@@ -35,7 +48,13 @@ public:
 
   //  void setSecondHitPattern(Trajectory* traj, reco::Track& track);
  private:
+  /// tracks with hit pattern and parameters at the PCA, the hits are not cloned
+  edm::OrphanHandle<reco::TrackCollection> putTracksOnly(edm::Event&, std::auto_ptr<reco::TrackCollection>&, AlgoProductCollection&);
+
   bool useSplitting;
+  bool tracksOnly_;
+  bool fillResiduals_;
+  reco::TrackResiduals::ResidualType residualType_;
 
 };
 
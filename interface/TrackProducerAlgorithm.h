@@ -11,6 +11,7 @@
 
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "DataFormats/TrackCandidate/interface/TrackCandidateCollection.h"
 #include "DataFormats/TrackReco/interface/Track.h"
 #include "DataFormats/TrackReco/interface/TrackExtra.h"
@@ -18,12 +19,14 @@
 #include "TrackingTools/TransientTrackingRecHit/interface/TransientTrackingRecHit.h"
 #include "TrackingTools/PatternTools/interface/TrackConstraintAssociation.h"
 #include "DataFormats/BeamSpot/interface/BeamSpot.h"
+#include "RecoTracker/TrackProducer/interface/TrackProducerProfiler.h"
+#include "TrackingTools/PatternTools/interface/Trajectory.h"
+#include "TrackingTools/PatternTools/interface/TSCBLBuilderNoMaterial.h"
 
 class MagneticField;
 class TrackingGeometry;
 class TrajectoryFitter;
 class Propagator;
-class Trajectory;
 class TrajectoryStateOnSurface;
 class TransientTrackingRecHitBuilder;
 
@@ -32,7 +35,8 @@ template <class T>
 class TrackProducerAlgorithm {
 public:
   typedef std::vector<T> TrackCollection;
-  typedef std::pair<Trajectory*, std::pair<T*,PropagationDirection> > AlgoProduct; 
+  /// fitted trajectory and track, owned by value (moved into the event by putInEvt)
+  typedef std::pair<Trajectory, std::pair<T,PropagationDirection> > AlgoProduct; 
   typedef std::vector< AlgoProduct >  AlgoProductCollection;
   typedef edm::RefToBase<TrajectorySeed> SeedRef;
   typedef edm::AssociationMap<edm::OneToOne<std::vector<T>,std::vector<VertexConstraint> > > 
@@ -44,19 +48,38 @@ public:
     conf_(conf),
     algoName_(conf_.getParameter<std::string>( "AlgorithmName" )),
     algo_(reco::TrackBase::algoByName(algoName_)),
-    reMatchSplitHits_(false)
+    reMatchSplitHits_(false),
+    cacheTransientHits_(false),
+    maxFitTime_(0),
+    candidateOrder_(inputOrder),
+    profiler_(0)
       {
         geometricInnerState_ = (conf_.exists("GeometricInnerState") ?
 	  conf_.getParameter<bool>( "GeometricInnerState" ) : true);
 	if (conf_.exists("reMatchSplitHits"))
 	  reMatchSplitHits_=conf_.getParameter<bool>("reMatchSplitHits");
+	if (conf_.exists("cacheTransientHits"))
+	  cacheTransientHits_=conf_.getParameter<bool>("cacheTransientHits");
+	if (conf_.exists("maxFitTimePerEvent"))
+	  maxFitTime_=conf_.getParameter<double>("maxFitTimePerEvent");
+	if (conf_.exists("candidateOrder")) {
+	  std::string order = conf_.getParameter<std::string>("candidateOrder");
+	  if (order == "") candidateOrder_ = inputOrder;
+	  else if (order == "nHits") candidateOrder_ = mostHitsFirst;
+	  else throw cms::Exception("TrackProducerAlgorithm") 
+	    << "unknown candidateOrder " << order << "! Set it to 'nHits' or leave it empty";
+	  // the order only matters when the budget may run out
+	  if (candidateOrder_ != inputOrder && maxFitTime_ <= 0) throw cms::Exception("TrackProducerAlgorithm")
+	    << "candidateOrder " << order << " has no effect without maxFitTimePerEvent! Leave it empty or set a time budget";
+	}
       }
 
   /// Destructor
   ~TrackProducerAlgorithm() {}
   
-  /// Run the Final Fit taking TrackCandidates as input
-  void runWithCandidate(const TrackingGeometry *, 
+  /// Run the Final Fit taking TrackCandidates as input.
+  /// Returns the number of candidates not fitted because the time budget (maxFitTimePerEvent) was exhausted
+  unsigned int runWithCandidate(const TrackingGeometry *, 
 			const MagneticField *, 
 			const TrackCandidateCollection&,
 			const TrajectoryFitter *,
@@ -107,7 +130,15 @@ public:
 			      const reco::BeamSpot&,
 			      AlgoProductCollection &);
 
-  /// Construct Tracks to be put in the event
+  /// Stage timing and counters are filled in the given profiler (not owned; 0 to disable)
+  void setProfiler(TrackProducerProfiler* profiler) { profiler_ = profiler; }
+
+  /// true if the fit of the candidates is limited by a per-event time budget
+  bool hasTimeBudget() const { return maxFitTime_>0; }
+
+  /// Construct Tracks to be put in the event. Each candidate is fitted on its own by the
+  /// TrajectoryFitter taken from the EventSetup under the "Fitter" name (looper mode if nLoops>0):
+  /// a fitter working on several tracks at once belongs there, not in this package
   bool buildTrack(const TrajectoryFitter *,
 		  const Propagator *,
 		  AlgoProductCollection& ,
@@ -116,6 +147,7 @@ public:
 		  const TrajectorySeed&,		  
 		  float,
 		  const reco::BeamSpot&,
+		  reco::TrackBase::TrackAlgorithm,
 		  SeedRef seedRef = SeedRef(),
 		  int qualityMask=0,
 		  signed char nLoops=0);
@@ -123,9 +155,20 @@ public:
  private:
   edm::ParameterSet conf_;  
   std::string algoName_;
+  // algorithm assigned to tracks built from candidates; refitted tracks keep their own
   reco::TrackBase::TrackAlgorithm algo_;
   bool reMatchSplitHits_;
   bool geometricInnerState_;
+  // build each physical hit shared by several inputs only once per event
+  bool cacheTransientHits_;
+  // per-event wall-clock budget for the fit of the candidates, in seconds (<=0: no limit)
+  double maxFitTime_;
+  // order in which the candidates are fitted; the products always follow the candidate order
+  enum CandidateOrder { inputOrder, mostHitsFirst };
+  CandidateOrder candidateOrder_;
+  TrackProducerProfiler* profiler_;
+  // stateless: one builder serves all the tracks
+  TSCBLBuilderNoMaterial tscblBuilder_;
 
   TrajectoryStateOnSurface getInitialState(const T * theT,
 					   TransientTrackingRecHit::RecHitContainer& hits,
@@ -145,6 +188,7 @@ TrackProducerAlgorithm<reco::Track>::buildTrack(const TrajectoryFitter *,
 						const TrajectorySeed&,
 						float,
 						const reco::BeamSpot&,
+						reco::TrackBase::TrackAlgorithm,
 						SeedRef seedRef,
 						int qualityMask,
 						signed char nLoops);
@@ -159,6 +203,7 @@ TrackProducerAlgorithm<reco::GsfTrack>::buildTrack(const TrajectoryFitter *,
 						   const TrajectorySeed&,
 						   float,
 						   const reco::BeamSpot&,
+						   reco::TrackBase::TrackAlgorithm,
 						   SeedRef seedRef,
 						   int qualityMask,
 						   signed char nLoops);
@@ -13,6 +13,7 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
 #include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
 
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/InputTag.h"
@@ -25,6 +26,16 @@
 #include "DataFormats/TrackerRecHit2D/interface/ClusterRemovalInfo.h"
 #include <RecoTracker/MeasurementDet/interface/MeasurementTracker.h>
 
+#include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
+#include "MagneticField/Records/interface/IdealMagneticFieldRecord.h" 
+#include "TrackingTools/Records/interface/TrackingComponentsRecord.h" 
+#include "TrackingTools/TrackFitters/interface/TrajectoryFitterRecord.h" 
+#include "TrackingTools/Records/interface/TransientRecHitRecord.h" 
+#include "RecoTracker/Record/interface/NavigationSchoolRecord.h"
+#include "RecoTracker/Record/interface/CkfComponentsRecord.h"
+
+#include "RecoTracker/TrackProducer/interface/TrackProducerProfiler.h"
+
 class Propagator;
 class TrajectoryStateUpdator;
 class MeasurementEstimator;
@@ -37,7 +48,7 @@ template <class T>
 class TrackProducerBase {
 public:
   typedef std::vector<T> TrackCollection;
-  typedef std::pair<Trajectory*, std::pair<T*,PropagationDirection> > AlgoProduct;
+  typedef std::pair<Trajectory, std::pair<T,PropagationDirection> > AlgoProduct;
   typedef std::vector< AlgoProduct >  AlgoProductCollection;
 public:
   /// Constructor
@@ -49,6 +60,7 @@ public:
   virtual ~TrackProducerBase();
   
   /// Get needed services from the Event Setup
+  /// (cached: each product is fetched again only when the IOV of its record changes)
   virtual void getFromES(const edm::EventSetup&,
 			 edm::ESHandle<TrackerGeometry>& ,
 			 edm::ESHandle<MagneticField>& ,
@@ -65,8 +77,8 @@ public:
   /// Method where the procduction take place. To be implemented in concrete classes
   virtual void produce(edm::Event&, const edm::EventSetup&) = 0;
 
-  /// Set parameter set
-  void setConf(const edm::ParameterSet& conf){conf_=conf;}
+  /// Set parameter set (and read the names of the EventSetup products)
+  void setConf(const edm::ParameterSet& conf);
 
   /// set label of source collection
   void setSrc(const edm::InputTag& src, const edm::InputTag& bsSrc){src_=src;bsSrc_=bsSrc;}
@@ -86,6 +98,11 @@ public:
   void setSecondHitPattern(Trajectory* traj, T& track, 
 			   const Propagator* prop, const MeasurementTracker* measTk );
 
+  /// Fills the expected inner/outer hits of all the fitted tracks (if a NavigationSchool is set);
+  /// the school, the propagator clone and the estimator are set up once for the whole collection
+  void setSecondHitPatterns(AlgoProductCollection& algoResults,
+			    const Propagator* prop, const MeasurementTracker* measTk );
+
   const edm::ParameterSet& getConf() const {return conf_;}
  private:
   edm::ParameterSet conf_;
@@ -93,14 +110,46 @@ public:
  protected:
   std::string alias_;
   bool trajectoryInEvent_;
+  /// deprecated: the tracks put by the last putInEvt, kept for the subclasses that build Refs
+  /// from it; use the handle returned by putInEvt instead
   edm::OrphanHandle<TrackCollection> rTracks_;
   edm::InputTag bsSrc_;
 
   bool rekeyClusterRefs_;
   edm::InputTag clusterRemovalInfo_;
 
+  /// invalid if no NavigationSchool is configured; refreshed by getFromES when its record changes
   edm::ESHandle<NavigationSchool> theSchool;
 
+  /// stage timing and track counters (untracked parameter stageProfiling)
+  TrackProducerProfiler profiler_;
+
+ private:
+  /// names of the EventSetup products, read once in setConf
+  std::string fitterName_;
+  std::string propagatorName_;
+  std::string builderName_;
+  std::string navigationSchoolName_;
+  std::string measTkName_;
+
+  void fillSecondHitPattern(Trajectory* traj, T& track, Propagator& localProp,
+			    const MeasurementEstimator& estimator, const MeasurementTracker* measTk);
+
+  /// EventSetup products cached across events, with the watchers of their records
+  edm::ESHandle<TrackerGeometry> cachedGeometry_;
+  edm::ESHandle<MagneticField> cachedField_;
+  edm::ESHandle<TrajectoryFitter> cachedFitter_;
+  edm::ESHandle<Propagator> cachedPropagator_;
+  edm::ESHandle<TransientTrackingRecHitBuilder> cachedBuilder_;
+  edm::ESHandle<MeasurementTracker> cachedMeasTk_;
+  edm::ESWatcher<TrackerDigiGeometryRecord> geometryWatcher_;
+  edm::ESWatcher<IdealMagneticFieldRecord> fieldWatcher_;
+  edm::ESWatcher<TrajectoryFitterRecord> fitterWatcher_;
+  edm::ESWatcher<TrackingComponentsRecord> propagatorWatcher_;
+  edm::ESWatcher<TransientRecHitRecord> builderWatcher_;
+  edm::ESWatcher<NavigationSchoolRecord> schoolWatcher_;
+  edm::ESWatcher<CkfComponentsRecord> measTkWatcher_;
+
 };
 
 #include "RecoTracker/TrackProducer/interface/TrackProducerBase.icc"
@@ -0,0 +1,88 @@
+#ifndef RecoTracker_TrackProducer_TrackProducerProfiler_h
+#define RecoTracker_TrackProducer_TrackProducerProfiler_h
+
+/** \class TrackProducerProfiler
+ *  Run-time instrumentation of the TrackProducer family (enabled with the untracked
+ *  parameter stageProfiling). Keeps, per module, the number of calls, the total time and
+ *  a log2 latency histogram of each stage, and track/hit counters per track algorithm.
+ *  The stage times are not split by algorithm: they are labelled with the module, and a
+ *  TrackProducer fits with the single algorithm of its AlgorithmName.
+ *  All counters are atomic. The summary is dumped at endJob as key=value lines
+ *  on the "TrackProducerProfile" category.
+ */
+
+#include "DataFormats/TrackReco/interface/TrackBase.h"
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+class TrackProducerProfiler {
+public:
+  enum Stage { hitBuilding=0, fit, beamLine, putInEvt, secondHitPattern, reKey, nStages };
+  /// bin i holds durations in [2^(i-1),2^i) ns, the last one everything above
+  static const unsigned int nBins = 32;
+  static const unsigned int nAlgos = reco::TrackBase::algoSize;
+
+  TrackProducerProfiler();
+
+  void setEnabled(bool enabled) { enabled_ = enabled; }
+  bool enabled() const { return enabled_; }
+  void setLabel(const std::string& label) { label_ = label; }
+
+  /// add one call of the stage
+  void fill(Stage stage, long long ns);
+  /// count a fitted track (nLoops>0: looper) and its hits
+  void countTrack(int algo, signed char nLoops, int foundHits, int lostHits);
+  /// count a fitted GsfTrack
+  void countGsfTrack(int algo);
+
+  /// machine-readable summary, one line per stage and per algorithm used
+  void print(std::ostream& os) const;
+  /// print() on the "TrackProducerProfile" category (if enabled)
+  void dump() const;
+
+  /// times the enclosing scope (no-op with a null or disabled profiler)
+  class Timer {
+  public:
+    Timer(TrackProducerProfiler* profiler, Stage stage) :
+      profiler_((profiler && profiler->enabled()) ? profiler : 0), stage_(stage) {
+      if (profiler_) start_ = std::chrono::steady_clock::now();
+    }
+    ~Timer() { stop(); }
+    /// record now instead of at the end of the scope
+    void stop() {
+      if (profiler_)
+	profiler_->fill(stage_,std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start_).count());
+      profiler_ = 0;
+    }
+  private:
+    Timer(const Timer&);
+    Timer& operator=(const Timer&);
+    TrackProducerProfiler* profiler_;
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+private:
+  TrackProducerProfiler(const TrackProducerProfiler&);
+  TrackProducerProfiler& operator=(const TrackProducerProfiler&);
+
+  static const char* stageName(Stage stage);
+
+  bool enabled_;
+  std::string label_;
+
+  std::atomic<long long> calls_[nStages];
+  std::atomic<long long> totalNs_[nStages];
+  std::atomic<long long> histogram_[nStages][nBins];
+
+  std::atomic<long long> tracks_[nAlgos];
+  std::atomic<long long> loopers_[nAlgos];
+  std::atomic<long long> gsfTracks_[nAlgos];
+  std::atomic<long long> foundHits_[nAlgos];
+  std::atomic<long long> lostHits_[nAlgos];
+};
+
+#endif
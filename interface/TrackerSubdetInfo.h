@@ -0,0 +1,43 @@
+#ifndef RecoTracker_TrackProducer_TrackerSubdetInfo_h
+#define RecoTracker_TrackProducer_TrackerSubdetInfo_h
+
+/** \class TrackerSubdetInfo
+ *  Properties of the tracker subdetectors, looked up by DetId::subdetId()
+ *  (3 bits: the table covers every value) instead of chains of comparisons.
+ *  Only meaningful for DetId::Tracker.
+ */
+
+#include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
+#include "DataFormats/SiStripDetId/interface/StripSubdetector.h"
+
+struct TrackerSubdetInfo {
+  /// parts of the tracker inside which barrel and forward hits are ordered together:
+  /// 0 none, 1 pixel, 2 TIB+TID, 3 TOB+TEC
+  unsigned char group;
+  bool isBarrel;
+  bool isStrip;
+};
+
+namespace trackerSubdetInfo {
+  constexpr TrackerSubdetInfo table[8] = {
+    {0, false, false},  // 0: not a tracker subdetector
+    {1, true,  false},  // PixelBarrel
+    {1, false, false},  // PixelEndcap
+    {2, true,  true },  // TIB
+    {2, false, true },  // TID
+    {3, true,  true },  // TOB
+    {3, false, true },  // TEC
+    {0, false, false}   // 7: unused
+  };
+
+  static_assert(PixelSubdetector::PixelBarrel==1 && PixelSubdetector::PixelEndcap==2 &&
+		StripSubdetector::TIB==3 && StripSubdetector::TID==4 &&
+		StripSubdetector::TOB==5 && StripSubdetector::TEC==6,
+		"the table follows the tracker subdetector numbering");
+}
+
+inline const TrackerSubdetInfo & trackerSubdet(unsigned int subdetId) {
+  return trackerSubdetInfo::table[subdetId & 0x7];
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include "Geometry/TrackerGeometryBuilder/interface/GeomDetLess.h"
 #include "Geometry/CommonDetUnit/interface/TrackingGeometry.h"
 #include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
+#include "DataFormats/Common/interface/OwnVector.h"
+#include "RecoTracker/TrackProducer/interface/TrackingRecHitSortByKey.h"
 
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
 
@@ -19,20 +21,25 @@ class TrackingRecHitLess {
 public:
 
   TrackingRecHitLess( const TrackingGeometry * geometry_, PropagationDirection dir = alongMomentum) :
-    g_(geometry_){
-    less_ = new GeomDetLess(dir);
-  }
+    g_(geometry_), less_(dir) {}
 
 
   bool operator()( const TrackingRecHit& a, const TrackingRecHit& b) const {
     
-    return  less_->operator()(
-			     g_->idToDet(a.geographicalId()), g_->idToDet(b.geographicalId()));
+    return  less_(g_->idToDet(a.geographicalId()), g_->idToDet(b.geographicalId()));
+  }
+
+  /// Sorts the hits with this ordering, looking up the GeomDet of each hit only once
+  /// (a plain sort with operator() does two lookups at every comparison).
+  /// The hits are not copied: references to them stay valid.
+  void sort( edm::OwnVector<TrackingRecHit>& hits) const {
+    const TrackingGeometry * g = g_;
+    sortHitsByKey<const GeomDet*>(hits, [g](const TrackingRecHit& hit) { return g->idToDet(hit.geographicalId()); }, less_);
   }
 
  private:
   const TrackingGeometry * g_;
-  GeomDetLess * less_;
+  GeomDetLess less_;
 };
 
 #endif
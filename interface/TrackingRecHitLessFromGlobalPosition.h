@@ -7,6 +7,7 @@
 #include "Geometry/TrackerGeometryBuilder/interface/GeomDetLess.h"
 #include "Geometry/CommonDetUnit/interface/TrackingGeometry.h"
 #include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
+#include "DataFormats/Common/interface/OwnVector.h"
 /** Defines order of layers in the Tracker as seen by straight tracks
  *  coming from the interaction region.
  */
@@ -15,6 +16,15 @@
 class TrackingRecHitLessFromGlobalPosition {
 public:
 
+  /// What the comparison uses of a hit: computed once per hit by key()
+  struct Key {
+    unsigned int subdet;
+    unsigned int group;    // hits of the same group (pixel, TIB+TID, TOB+TEC) are compared by position; 0: none
+    bool barrel;
+    unsigned int perp;     // global r and |z|, in units of 1E-7 cm
+    unsigned int absZ;
+  };
+
   TrackingRecHitLessFromGlobalPosition( const TrackingGeometry * geometry_, PropagationDirection dir = alongMomentum) :
     geometry(geometry_), theDir(dir){  }
   
@@ -23,13 +33,25 @@ public:
     if (theDir == alongMomentum) return insideOutLess( a, b);
     else return insideOutLess( b, a);
   }
+
+  bool operator()( const Key& a, const Key& b) const {
+    if (theDir == alongMomentum) return insideOutLess( a, b);
+    else return insideOutLess( b, a);
+  }
+
+  /// One geometry lookup and frame transformation
+  Key key( const TrackingRecHit& hit) const;
+
+  /// Sorts the hits with this ordering, computing the key of each hit only once
+  /// (a plain sort with operator() computes it at every comparison)
+  void sort( edm::OwnVector<TrackingRecHit>& hits) const;
   
  private:
 
-  bool insideOutLess(  const TrackingRecHit& a, const TrackingRecHit& b) const;
-  
-  bool barrelForwardLess(  const TrackingRecHit& a, const TrackingRecHit& b) const;
-  
+  /// positions are only computed for hits of the same group
+  bool insideOutLess( const TrackingRecHit& a, const TrackingRecHit& b) const;
+
+  static bool insideOutLess( const Key& a, const Key& b);
   
   const TrackingGeometry * geometry;
   PropagationDirection theDir;
@@ -0,0 +1,39 @@
+#ifndef RecoTracker_TrackProducer_TrackingRecHitSortByKey_h
+#define RecoTracker_TrackProducer_TrackingRecHitSortByKey_h
+
+/** Sorts an OwnVector of hits with an ordering of per-hit keys: keyOf is called once per hit
+ *  and the (key,index) array is sorted with less. The OwnVector is then sorted by the rank of
+ *  each hit in that order: only its pointers move, the hits stay where they are.
+ *  The keys see the same sequence of comparisons as OwnVector::sort with the equivalent hit
+ *  comparison, so the resulting order is the same.
+ */
+
+#include "DataFormats/Common/interface/OwnVector.h"
+#include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template <class Key, class KeyOf, class KeyLess>
+void sortHitsByKey( edm::OwnVector<TrackingRecHit>& hits, const KeyOf& keyOf, const KeyLess& less) {
+  typedef std::pair<Key, unsigned int> KeyIndex;
+  std::vector<KeyIndex> keys;
+  keys.reserve(hits.size());
+  for (unsigned int i=0; i!=hits.size(); ++i) keys.push_back(KeyIndex(keyOf(hits[i]), i));
+  std::sort(keys.begin(), keys.end(),
+	    [&less](const KeyIndex& a, const KeyIndex& b) { return less(a.first, b.first); });
+
+  unsigned int k = 0;
+  while (k!=keys.size() && keys[k].second==k) ++k;
+  if (k==keys.size()) return;   // already in order
+
+  // rank of each hit, by address (the hits do not move while the OwnVector is sorted)
+  std::unordered_map<const TrackingRecHit*, unsigned int> rank(2*hits.size());
+  for (k=0; k!=keys.size(); ++k) rank[&hits[keys[k].second]] = k;
+  hits.sort([&rank](const TrackingRecHit& a, const TrackingRecHit& b) {
+      return rank.find(&a)->second < rank.find(&b)->second; });
+}
+
+#endif
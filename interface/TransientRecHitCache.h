@@ -0,0 +1,62 @@
+#ifndef RecoTracker_TrackProducer_TransientRecHitCache_h
+#define RecoTracker_TrackProducer_TransientRecHitCache_h
+
+/** \class TransientRecHitCache
+ *  Per-event cache in front of a TransientTrackingRecHitBuilder.
+ *  Overlapping candidates (or tracks) carry their own copies of the same physical hit:
+ *  a hit with the same DetId, concrete type, cluster(s) and local parameters of one
+ *  already built is not built again (no second CPE evaluation), the transient hit is shared.
+ *  The cache stores pointers to the persistent hits: it must not outlive the event.
+ */
+
+#include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
+#include "TrackingTools/TransientTrackingRecHit/interface/TransientTrackingRecHit.h"
+#include "TrackingTools/TransientTrackingRecHit/interface/TransientTrackingRecHitBuilder.h"
+
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+class TransientRecHitCache {
+public:
+  /// if not enabled, build() just forwards to the builder
+  TransientRecHitCache(const TransientTrackingRecHitBuilder * builder, bool enabled) :
+    builder_(builder), enabled_(enabled) {}
+
+  TransientTrackingRecHit::RecHitPointer build(const TrackingRecHit * hit) {
+    if (!enabled_ || !hit->isValid()) return builder_->build(hit);
+    std::vector<Entry> & entries = cache_[hit->geographicalId().rawId()];
+    for (std::vector<Entry>::const_iterator e=entries.begin(); e!=entries.end(); ++e) {
+      if (sameHit(*e->hit,*hit)) return e->ttrh;
+    }
+    entries.push_back(Entry(hit,builder_->build(hit)));
+    return entries.back().ttrh;
+  }
+
+  void clear() { cache_.clear(); }
+
+private:
+  struct Entry {
+    Entry(const TrackingRecHit * h, const TransientTrackingRecHit::RecHitPointer & t) : hit(h), ttrh(t) {}
+    const TrackingRecHit * hit;
+    TransientTrackingRecHit::RecHitPointer ttrh;
+  };
+
+  // same DetId is guaranteed by the key
+  static bool sameHit(const TrackingRecHit & a, const TrackingRecHit & b) {
+    if (&a == &b) return true;
+    if (typeid(a) != typeid(b)) return false;
+    if (!a.sharesInput(&b,TrackingRecHit::all)) return false;
+    // candidates may carry hits re-evaluated with different track angles: compare the local parameters too
+    LocalPoint pa = a.localPosition(), pb = b.localPosition();
+    if (pa.x()!=pb.x() || pa.y()!=pb.y() || pa.z()!=pb.z()) return false;
+    LocalError ea = a.localPositionError(), eb = b.localPositionError();
+    return ea.xx()==eb.xx() && ea.xy()==eb.xy() && ea.yy()==eb.yy();
+  }
+
+  const TransientTrackingRecHitBuilder * builder_;
+  bool enabled_;
+  std::unordered_map<unsigned int, std::vector<Entry> > cache_;
+};
+
+#endif
@@ -21,6 +21,8 @@ GsfTrackProducer::GsfTrackProducer(const edm::ParameterSet& iConfig):
   theAlgo(iConfig)
 {
   setConf(iConfig);
+  theAlgo.setProfiler(&profiler_);
+  if (iConfig.exists("validateMode")) setValidateMode(iConfig.getParameter<bool>("validateMode"));
   setSrc( iConfig.getParameter<edm::InputTag>( "src" ), iConfig.getParameter<edm::InputTag>( "beamSpot" ));
   setAlias( iConfig.getParameter<std::string>( "@module_label" ) );
 //   string a = alias_;
@@ -32,6 +34,8 @@ GsfTrackProducer::GsfTrackProducer(const edm::ParameterSet& iConfig):
   produces<TrackingRecHitCollection>().setBranchAlias( alias_ + "RecHits" );
   produces<std::vector<Trajectory> >() ;
   produces<TrajGsfTrackAssociationCollection>();
+  // with a time budget the event is flagged with the number of candidates left unfitted
+  if (theAlgo.hasTimeBudget()) produces<unsigned int>("skippedCandidates");
 
 }
 
@@ -64,6 +68,7 @@ void GsfTrackProducer::produce(edm::Event& theEvent, const edm::EventSetup& setu
   //
   AlgoProductCollection algoResults;
   reco::BeamSpot bs;
+  unsigned int nSkipped = 0;
   try{  
     edm::Handle<TrackCandidateCollection> theTCCollection;
     getFromEvt(theEvent,theTCCollection,bs);
@@ -72,9 +77,14 @@ void GsfTrackProducer::produce(edm::Event& theEvent, const edm::EventSetup& setu
     //run the algorithm  
     //
     LogDebug("GsfTrackProducer") << "run the algorithm" << "\n";
-    theAlgo.runWithCandidate(theG.product(), theMF.product(), *theTCCollection, 
-			     theFitter.product(), thePropagator.product(), theBuilder.product(), bs, algoResults);
+    nSkipped = theAlgo.runWithCandidate(theG.product(), theMF.product(), *theTCCollection, 
+					theFitter.product(), thePropagator.product(), theBuilder.product(), bs, algoResults);
   } catch (cms::Exception &e){ edm::LogInfo("GsfTrackProducer") << "cms::Exception caught!!!" << "\n" << e << "\n"; throw; }
+
+  if (theAlgo.hasTimeBudget()) {
+    std::auto_ptr<unsigned int> skipped(new unsigned int(nSkipped));
+    theEvent.put(skipped,"skippedCandidates");
+  }
   //
   //put everything in the event
   putInEvt(theEvent, thePropagator.product(), theMeasTk.product(), outputRHColl, outputTColl, outputTEColl, outputGsfTEColl,
@@ -17,6 +17,9 @@ public:
 
   virtual void produce(edm::Event&, const edm::EventSetup&) override;
 
+  /// Dump the stage profile (if enabled)
+  virtual void endJob() override { profiler_.dump(); }
+
 private:
   TrackProducerAlgorithm<reco::GsfTrack> theAlgo;
 
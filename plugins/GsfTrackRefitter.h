@@ -18,6 +18,9 @@ public:
   /// Implementation of produce method
   virtual void produce(edm::Event&, const edm::EventSetup&) override;
 
+  /// Dump the stage profile (if enabled)
+  virtual void endJob() override { profiler_.dump(); }
+
 private:
   TrackProducerAlgorithm<reco::GsfTrack> theAlgo;
   enum Constraint { none, 
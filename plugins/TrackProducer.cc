@@ -18,6 +18,8 @@ TrackProducer::TrackProducer(const edm::ParameterSet& iConfig):
   theAlgo(iConfig)
 {
   setConf(iConfig);
+  theAlgo.setProfiler(&profiler_);
+  if (iConfig.exists("residuals")) setResiduals(iConfig.getParameter<std::string>("residuals"));
   setSrc( iConfig.getParameter<edm::InputTag>( "src" ), iConfig.getParameter<edm::InputTag>( "beamSpot" ));
   setAlias( iConfig.getParameter<std::string>( "@module_label" ) );
 
@@ -26,12 +28,21 @@ TrackProducer::TrackProducer(const edm::ParameterSet& iConfig):
         if (!(tag == edm::InputTag())) { setClusterRemovalInfo( tag ); }
   }
 
+  bool tracksOnly = iConfig.exists("tracksOnly") ? iConfig.getParameter<bool>("tracksOnly") : false;
+  setTracksOnly(tracksOnly);
+
   //register your products
   produces<reco::TrackCollection>().setBranchAlias( alias_ + "Tracks" );
-  produces<reco::TrackExtraCollection>().setBranchAlias( alias_ + "TrackExtras" );
-  produces<TrackingRecHitCollection>().setBranchAlias( alias_ + "RecHits" );
-  produces<std::vector<Trajectory> >() ;
-  produces<TrajTrackAssociationCollection>();
+  if (!tracksOnly) {
+    produces<reco::TrackExtraCollection>().setBranchAlias( alias_ + "TrackExtras" );
+    produces<TrackingRecHitCollection>().setBranchAlias( alias_ + "RecHits" );
+    produces<std::vector<Trajectory> >() ;
+    produces<TrajTrackAssociationCollection>();
+  } else if (trajectoryInEvent_) {
+    edm::LogWarning("TrackProducer") << "tracksOnly is set: TrajectoryInEvent is ignored";
+  }
+  // with a time budget the event is flagged with the number of candidates left unfitted
+  if (theAlgo.hasTimeBudget()) produces<unsigned int>("skippedCandidates");
 
 }
 
@@ -64,6 +75,7 @@ void TrackProducer::produce(edm::Event& theEvent, const edm::EventSetup& setup)
   AlgoProductCollection algoResults;
   edm::Handle<TrackCandidateCollection> theTCCollection;
   reco::BeamSpot bs;
+  unsigned int nSkipped = 0;
   getFromEvt(theEvent,theTCCollection,bs);
   //protect against missing product  
   if (theTCCollection.failedToGet()){
@@ -71,11 +83,16 @@ void TrackProducer::produce(edm::Event& theEvent, const edm::EventSetup& setup)
   else{
     LogDebug("TrackProducer") << "run the algorithm" << "\n";
     try{  
-      theAlgo.runWithCandidate(theG.product(), theMF.product(), *theTCCollection, 
-			       theFitter.product(), thePropagator.product(), theBuilder.product(), bs, algoResults);
+      nSkipped = theAlgo.runWithCandidate(theG.product(), theMF.product(), *theTCCollection, 
+					  theFitter.product(), thePropagator.product(), theBuilder.product(), bs, algoResults);
     } catch (cms::Exception &e){ edm::LogError("TrackProducer") << "cms::Exception caught during theAlgo.runWithCandidate." << "\n" << e << "\n"; throw;}
   }
   
+  if (theAlgo.hasTimeBudget()) {
+    std::auto_ptr<unsigned int> skipped(new unsigned int(nSkipped));
+    theEvent.put(skipped,"skippedCandidates");
+  }
+
   //put everything in the event
   putInEvt(theEvent, thePropagator.product(),theMeasTk.product(), outputRHColl, outputTColl, outputTEColl, outputTrajectoryColl, algoResults);
   LogDebug("TrackProducer") << "end" << "\n";
@@ -120,8 +137,9 @@ std::vector<reco::TransientTrack> TrackProducer::getTransient(edm::Event& theEve
     catch (cms::Exception &e){ edm::LogError("TrackProducer") << "cms::Exception caught during theAlgo.runWithCandidate." << "\n" << e << "\n"; throw; }
   }
   
+  ttks.reserve(algoResults.size());
   for (AlgoProductCollection::iterator prod=algoResults.begin();prod!=algoResults.end(); prod++){
-    ttks.push_back( reco::TransientTrack(*((*prod).second.first),thePropagator.product()->magneticField() ));
+    ttks.push_back( reco::TransientTrack((*prod).second.first,thePropagator.product()->magneticField() ));
   }
 
   LogDebug("TrackProducer") << "end" << "\n";
@@ -23,6 +23,9 @@ public:
   /// Implementation of produce method
   virtual void produce(edm::Event&, const edm::EventSetup&) override;
 
+  /// Dump the stage profile (if enabled)
+  virtual void endJob() override { profiler_.dump(); }
+
   /// Get Transient Tracks
   std::vector<reco::TransientTrack> getTransient(edm::Event&, const edm::EventSetup&);
 
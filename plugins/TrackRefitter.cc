@@ -16,6 +16,8 @@ TrackRefitter::TrackRefitter(const edm::ParameterSet& iConfig):
   theAlgo(iConfig)
 {
   setConf(iConfig);
+  theAlgo.setProfiler(&profiler_);
+  if (iConfig.exists("residuals")) setResiduals(iConfig.getParameter<std::string>("residuals"));
   setSrc( iConfig.getParameter<edm::InputTag>( "src" ), iConfig.getParameter<edm::InputTag>( "beamSpot" ));
   setAlias( iConfig.getParameter<std::string>( "@module_label" ) );
   std::string  constraint_str = iConfig.getParameter<std::string>( "constraint" );
@@ -4,6 +4,7 @@ TrackProducer = cms.EDProducer("TrackProducer",
     src = cms.InputTag("ckfTrackCandidates"),
     clusterRemovalInfo = cms.InputTag(""),
     beamSpot = cms.InputTag("offlineBeamSpot"),
+    # TrajectoryFitter ESProducer used for the final fit of every candidate
     Fitter = cms.string('KFFittingSmootherWithOutliersRejectionAndRK'),
     useHitsSplitting = cms.bool(False),
     alias = cms.untracked.string('ctfWithMaterialTracks'),
@@ -18,6 +19,25 @@ TrackProducer = cms.EDProducer("TrackProducer",
     # true for cosmics/beam halo, false for collision tracks (needed by loopers)
     GeometricInnerState = cms.bool(False),
 
+    # build the transient hits shared by several candidates only once per event
+    cacheTransientHits = cms.bool(False),
+
+    # per-event wall-clock budget (s) for the final fit, <=0 for no limit;
+    # when exhausted the remaining candidates are not fitted and their number
+    # is stored as "skippedCandidates"
+    maxFitTimePerEvent = cms.double(0.),
+    # order in which the candidates are fitted ('' as in input, 'nHits' most hits first,
+    # only with maxFitTimePerEvent); the produced tracks always keep the order of the candidates
+    candidateOrder = cms.string(''),
+
+    # put only the tracks (hit pattern and parameters at the PCA) in the event:
+    # no TrackExtras, rechits or trajectories (for consumers that never read the extras)
+    tracksOnly = cms.bool(False),
+
+    # residuals stored in the TrackExtras: 'off', 'X_Y_RESIDUALS' or 'X_Y_PULLS'
+    # (X_Y_PULLS if the parameter is missing); 'off' saves their computation where they are not read
+    residuals = cms.string('X_Y_PULLS'),
+
     ### These are paremeters related to the filling of the Secondary hit-patterns                               
     #set to "", the secondary hit pattern will not be filled (backward compatible with DetLayer=0)    
     NavigationSchool = cms.string('SimpleNavigationSchool'),          
@@ -29,6 +29,12 @@ TrackRefitter = cms.EDProducer("TrackRefitter",
     # true for cosmics, false for collision tracks (needed by loopers)
     GeometricInnerState = cms.bool(False),
 
+    # build the transient hits shared by several tracks only once per event
+    cacheTransientHits = cms.bool(False),
+
+    # residuals stored in the TrackExtras: 'off', 'X_Y_RESIDUALS' or 'X_Y_PULLS'
+    residuals = cms.string('X_Y_PULLS'),
+
     # Navigation school is necessary to fill the secondary hit patterns                         
     NavigationSchool = cms.string('SimpleNavigationSchool'),
     MeasurementTracker = cms.string(''),                                              
@@ -1,37 +1,130 @@
 #include "RecoTracker/TrackProducer/interface/ClusterRemovalRefSetter.h"
 #include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
 
+#include <algorithm>
+#include <vector>
+
 ClusterRemovalRefSetter::ClusterRemovalRefSetter(const edm::Event &iEvent, const edm::InputTag& tag) {
     edm::Handle<reco::ClusterRemovalInfo> hCRI;
     iEvent.getByLabel(tag, hCRI);
     cri_ = &*hCRI; 
 
+    hasPixel_ = cri_->hasPixel();
+    hasStrip_ = cri_->hasStrip();
+    pixelIndices_ = &cri_->pixelIndices();
+    stripIndices_ = &cri_->stripIndices();
+    pixelNewId_ = cri_->pixelNewRefProd().id();
+    stripNewId_ = cri_->stripNewRefProd().id();
+
     //std::cout << "Rekeying PIXEL ProdID " << cri_->pixelNewRefProd().id() << " => " << cri_->pixelRefProd().id() << std::endl;
     //std::cout << "Rekeying STRIP ProdID " << cri_->stripNewRefProd().id() << " => " << cri_->stripRefProd().id() << std::endl;
 }
 
-void ClusterRemovalRefSetter::reKey(TrackingRecHit *hit) const {
-    if (!hit->isValid()) return;
-    DetId detid = hit->geographicalId(); 
+ClusterRemovalRefSetter::HitType ClusterRemovalRefSetter::hitType(const TrackingRecHit &hit) const {
+    if (!hit.isValid()) return skipHit;
+    DetId detid = hit.geographicalId(); 
     uint32_t subdet = detid.subdetId();
     if ((subdet == PixelSubdetector::PixelBarrel) || (subdet == PixelSubdetector::PixelEndcap)) {
-        if (!cri_->hasPixel()) return;
-        reKeyPixel(reinterpret_cast<SiPixelRecHit *>(hit)->omniCluster());
-    } else {
-        if (!cri_->hasStrip()) return;
-        const std::type_info &type = typeid(*hit);
-        if (type == typeid(SiStripRecHit2D)) {
-            reKeyStrip(reinterpret_cast<SiStripRecHit2D *>(hit)->omniCluster());
-	} else if (type == typeid(SiStripRecHit1D)) {
-            reKeyStrip(reinterpret_cast<SiStripRecHit1D *>(hit)->omniCluster());
-        } else if (type == typeid(SiStripMatchedRecHit2D)) {
-            SiStripMatchedRecHit2D *mhit = reinterpret_cast<SiStripMatchedRecHit2D *>(hit);
-            reKeyStrip(mhit->monoClusterRef());
-            reKeyStrip(mhit->stereoClusterRef());
-        } else if (type == typeid(ProjectedSiStripRecHit2D)) {
-            ProjectedSiStripRecHit2D *phit = reinterpret_cast<ProjectedSiStripRecHit2D *>(hit);
-            reKeyStrip(phit->originalHit().omniCluster());
-        } else throw cms::Exception("Unknown RecHit Type") << "RecHit of type " << type.name() << " not supported. (use c++filt to demangle the name)";
+        return hasPixel_ ? pixelHit : skipHit;
+    }
+    if (!hasStrip_) return skipHit;
+    const std::type_info &type = typeid(hit);
+    if (type == typeid(SiStripRecHit2D)) return stripHit2D;
+    if (type == typeid(SiStripMatchedRecHit2D)) return matchedHit;
+    if (type == typeid(SiStripRecHit1D)) return stripHit1D;
+    if (type == typeid(ProjectedSiStripRecHit2D)) return projectedHit;
+    throw cms::Exception("Unknown RecHit Type") << "RecHit of type " << type.name() << " not supported. (use c++filt to demangle the name)";
+}
+
+void ClusterRemovalRefSetter::reKey(TrackingRecHit *hit) const {
+    reKey(hit, hitType(*hit));
+}
+
+void ClusterRemovalRefSetter::reKey(TrackingRecHit *hit, HitType type) const {
+    switch (type) {
+    case pixelHit:
+        reKeyPixel(static_cast<SiPixelRecHit *>(hit)->omniCluster());
+        break;
+    case stripHit2D:
+        reKeyStrip(static_cast<SiStripRecHit2D *>(hit)->omniCluster());
+        break;
+    case stripHit1D:
+        reKeyStrip(static_cast<SiStripRecHit1D *>(hit)->omniCluster());
+        break;
+    case matchedHit: {
+        SiStripMatchedRecHit2D *mhit = static_cast<SiStripMatchedRecHit2D *>(hit);
+        reKeyStrip(mhit->monoClusterRef());
+        reKeyStrip(mhit->stereoClusterRef());
+        break;
+    }
+    case projectedHit:
+        reKeyStrip(static_cast<ProjectedSiStripRecHit2D *>(hit)->originalHit().omniCluster());
+        break;
+    default:
+        break;
+    }
+}
+
+void ClusterRemovalRefSetter::reKey(TrackingRecHitCollection &hits, IndexMap *indexMap) const {
+    // the cluster refs to rekey, by detector
+    std::vector<OmniClusterRef *> pixelRefs, stripRefs;
+    for (TrackingRecHitCollection::iterator it = hits.begin(), ed = hits.end(); it != ed; ++it) {
+        switch (hitType(*it)) {
+        case pixelHit:
+            pixelRefs.push_back(&static_cast<SiPixelRecHit &>(*it).omniCluster());
+            break;
+        case stripHit2D:
+            stripRefs.push_back(&static_cast<SiStripRecHit2D &>(*it).omniCluster());
+            break;
+        case stripHit1D:
+            stripRefs.push_back(&static_cast<SiStripRecHit1D &>(*it).omniCluster());
+            break;
+        case matchedHit: {
+            SiStripMatchedRecHit2D &mhit = static_cast<SiStripMatchedRecHit2D &>(*it);
+            stripRefs.push_back(&mhit.monoClusterRef());
+            stripRefs.push_back(&mhit.stereoClusterRef());
+            break;
+        }
+        case projectedHit:
+            stripRefs.push_back(&static_cast<ProjectedSiStripRecHit2D &>(*it).originalHit().omniCluster());
+            break;
+        default:
+            break;
+        }
+    }
+
+    // nothing is changed if any ref does not point to the cleaned collections
+    checkProductIDs(pixelRefs, pixelNewId_, "pixel");
+    checkProductIDs(stripRefs, stripNewId_, "strip");
+
+    translate<ClusterPixelRef>(pixelRefs, *pixelIndices_, cri_->pixelRefProd(), indexMap ? &indexMap->pixel : 0);
+    translate<ClusterStripRef>(stripRefs, *stripIndices_, cri_->stripRefProd(), indexMap ? &indexMap->strip : 0);
+}
+
+void ClusterRemovalRefSetter::checkProductIDs(const std::vector<OmniClusterRef*>& refs, const edm::ProductID& expected, const char* what) const {
+    for (std::vector<OmniClusterRef *>::const_iterator it = refs.begin(), ed = refs.end(); it != ed; ++it) {
+        if ((*it)->id() != expected) {
+            throw cms::Exception("Inconsistent Data") << "ClusterRemovalRefSetter: " << 
+              "Existing " << what << " cluster refers to product ID " << (*it)->id() << 
+              " while the ClusterRemovalInfo expects as *new* cluster collection the ID " << expected << "\n";
+        }
+    }
+}
+
+template <class ClusterRef, class RefProd>
+void ClusterRemovalRefSetter::translate(const std::vector<OmniClusterRef*>& refs, const reco::ClusterRemovalInfo::Indices& indices,
+                                        const RefProd& oldRefProd, std::vector<std::pair<unsigned int, unsigned int> >* map) {
+    if (map) map->reserve(map->size() + refs.size());
+    for (std::vector<OmniClusterRef *>::const_iterator it = refs.begin(), ed = refs.end(); it != ed; ++it) {
+        size_t newIndex = (*it)->key();
+        assert(newIndex < indices.size());
+        size_t oldIndex = indices[newIndex];
+        if (map) map->push_back(std::make_pair(oldIndex, newIndex));
+        **it = OmniClusterRef(ClusterRef(oldRefProd, oldIndex));
+    }
+    if (map) {
+        std::sort(map->begin(), map->end());
+        map->erase(std::unique(map->begin(), map->end()), map->end());
     }
 }
 
@@ -39,12 +132,12 @@ void ClusterRemovalRefSetter::reKey(TrackingRecHit *hit) const {
 void ClusterRemovalRefSetter::reKeyPixel(OmniClusterRef& newRef) const {
   // "newRef" as it refs to the "new"(=cleaned) collection, instead of the old one
   using reco::ClusterRemovalInfo;
-  const ClusterRemovalInfo::Indices &indices = cri_->pixelIndices();
+  const ClusterRemovalInfo::Indices &indices = *pixelIndices_;
   
-  if (newRef.id()  != cri_->pixelNewRefProd().id()) {
+  if (newRef.id()  != pixelNewId_) {
     throw cms::Exception("Inconsistent Data") << "ClusterRemovalRefSetter: " << 
       "Existing pixel cluster refers to product ID " << newRef.id() << 
-      " while the ClusterRemovalInfo expects as *new* cluster collection the ID " << cri_->pixelNewRefProd().id() << "\n";
+      " while the ClusterRemovalInfo expects as *new* cluster collection the ID " << pixelNewId_ << "\n";
   }
   size_t newIndex = newRef.key();
   assert(newIndex < indices.size());
@@ -57,12 +150,12 @@ void ClusterRemovalRefSetter::reKeyPixel(OmniClusterRef& newRef) const {
 void ClusterRemovalRefSetter::reKeyStrip(OmniClusterRef& newRef) const {
   // "newRef" as it refs to the "new"(=cleaned) collection, instead of the old one
   using reco::ClusterRemovalInfo;
-  const ClusterRemovalInfo::Indices &indices = cri_->stripIndices();
+  const ClusterRemovalInfo::Indices &indices = *stripIndices_;
   
-  if (newRef.id() != cri_->stripNewRefProd().id()) {   // this is a cfg error in the tracking configuration, much more likely
+  if (newRef.id() != stripNewId_) {   // this is a cfg error in the tracking configuration, much more likely
     throw cms::Exception("Inconsistent Data") << "ClusterRemovalRefSetter: " << 
       "Existing strip cluster refers to product ID " << newRef.id() << 
-      " while the ClusterRemovalInfo expects as *new* cluster collection the ID " << cri_->stripNewRefProd().id() << "\n";
+      " while the ClusterRemovalInfo expects as *new* cluster collection the ID " << stripNewId_ << "\n";
   }
   
   size_t newIndex = newRef.key();
@@ -71,5 +164,3 @@ void ClusterRemovalRefSetter::reKeyStrip(OmniClusterRef& newRef) const {
   ClusterStripRef oldRef(cri_->stripRefProd(), oldIndex);
   newRef = OmniClusterRef(oldRef);
 }
-
-
@@ -1,6 +1,7 @@
 #include "RecoTracker/TrackProducer/interface/GsfTrackProducerBase.h"
 // system include files
 #include <memory>
+#include <algorithm>
 // user include files
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
@@ -12,6 +13,7 @@
 #include "TrackingTools/GsfTools/interface/GsfPropagatorAdapter.h"
 #include "TrackingTools/GsfTools/interface/MultiGaussianStateTransform.h"
 #include "TrackingTools/GsfTools/interface/MultiGaussianState1D.h"
+#include "TrackingTools/GsfTools/interface/SingleGaussianState1D.h"
 #include "TrackingTools/GsfTools/interface/GaussianSumUtilities1D.h"
 #include "TrackingTools/PatternTools/interface/TransverseImpactPointExtrapolator.h"
 #include "TrackingTools/PatternTools/interface/TSCBLBuilderNoMaterial.h"
@@ -22,8 +24,9 @@
 
 #include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
 #include "DataFormats/SiStripDetId/interface/SiStripDetId.h"
+#include "RecoTracker/TrackProducer/interface/TrackerSubdetInfo.h"
 
-void 
+edm::OrphanHandle<reco::GsfTrackCollection>
 GsfTrackProducerBase::putInEvt(edm::Event& evt,
 			       const Propagator* prop,
 			       const MeasurementTracker* measTk,
@@ -35,6 +38,7 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
 			       AlgoProductCollection& algoResults,
 			       const reco::BeamSpot& bs)
 {
+  TrackProducerProfiler::Timer timer(&profiler_,TrackProducerProfiler::putInEvt);
 
   TrackingRecHitRefProd rHits = evt.getRefBeforePut<TrackingRecHitCollection>();
   reco::TrackExtraRefProd rTrackExtras = evt.getRefBeforePut<reco::TrackExtraCollection>();
@@ -49,28 +53,37 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
   std::map<unsigned int, unsigned int> tjTkMap;
 
   TSCBLBuilderNoMaterial tscblBuilder;
+  // propagator and extrapolator for the mode at the vertex: built once per event,
+  //   at the first valid inner state (all the states share the same field)
+  std::unique_ptr<GsfPropagatorAdapter> gsfProp;
+  std::unique_ptr<TransverseImpactPointExtrapolator> tipExtrapolator;
+
+  // one allocation per output collection (split hits may still add a few)
+  size_t nMeasurements = 0;
+  for(AlgoProductCollection::const_iterator i=algoResults.begin(); i!=algoResults.end();i++)
+    nMeasurements += (*i).first.measurements().size();
+  selTracks->reserve(selTracks->size()+algoResults.size());
+  selTrackExtras->reserve(selTrackExtras->size()+algoResults.size());
+  selGsfTrackExtras->reserve(selGsfTrackExtras->size()+algoResults.size());
+  selHits->reserve(selHits->size()+nMeasurements);
+  if(trajectoryInEvent_) selTrajectories->reserve(selTrajectories->size()+algoResults.size());
+
+  // second hit pattern: filled on the fitted tracks before they are copied to the output
+  setSecondHitPatterns(algoResults,prop,measTk);
   
   for(AlgoProductCollection::iterator i=algoResults.begin(); i!=algoResults.end();i++){
-    Trajectory * theTraj = (*i).first;
-    if(trajectoryInEvent_) {
-      selTrajectories->push_back(*theTraj);
-      iTjRef++;
-    }
+    Trajectory * theTraj = &(*i).first;
 
     // const TrajectoryFitter::RecHitContainer& transHits = theTraj->recHits(useSplitting);  // NO: the return type in Trajectory is by VALUE
     TrajectoryFitter::RecHitContainer transHits = theTraj->recHits(useSplitting);
-    reco::GsfTrack * theTrack = (*i).second.first;
+    const reco::GsfTrack & theTrack = (*i).second.first;
     PropagationDirection seedDir = (*i).second.second;  
     
     LogDebug("TrackProducer") << "In GsfTrackProducerBase::putInEvt - seedDir=" << seedDir;
 
-    reco::GsfTrack t = * theTrack;
-    selTracks->push_back( t );
+    selTracks->push_back( theTrack );
     iTkRef++;
 
-    // Store indices in local map (starts at 0)
-    if(trajectoryInEvent_) tjTkMap[iTjRef-1] = iTkRef-1;
-
     //sets the outermost and innermost TSOSs
     TrajectoryStateOnSurface outertsos;
     TrajectoryStateOnSurface innertsos;
@@ -103,14 +116,6 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
     reco::GsfTrack & track = selTracks->back();
     track.setExtra( teref );
     
-    //======= I want to set the second hitPattern here =============
-    if (theSchool.isValid())
-      {
-	NavigationSetter setter( *theSchool );
-	setSecondHitPattern(theTraj,track,prop,measTk);
-      }
-    //==============================================================
-    
     selTrackExtras->push_back( reco::TrackExtra (outpos, outmom, true, inpos, inmom, true,
 						 outertsos.curvilinearError(), outerId,
 						 innertsos.curvilinearError(), innerId,
@@ -171,11 +176,7 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
 	if ( i->recHit().get() ) {
 	  DetId detId(i->recHit()->geographicalId());
 	  if ( detId.det()==DetId::Tracker ) {
-	    int subdetId = detId.subdetId();
-	    if ( subdetId==SiStripDetId::TIB || subdetId==SiStripDetId::TID || 
-		 subdetId==SiStripDetId::TOB || subdetId==SiStripDetId::TEC ) {
-	      if ( SiStripDetId(detId).stereo() )  continue;	    
-	    }
+	    if ( trackerSubdet(detId.subdetId()).isStrip && SiStripDetId(detId).stereo() )  continue;
 	  }
 	}
 	bool valid = computeModeAtTM(*i,position,momentum,deltaP);
@@ -202,13 +203,22 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
 						       tangents));
 
     if ( innertsos.isValid() ) {
-      GsfPropagatorAdapter gsfProp(AnalyticalPropagator(innertsos.magneticField(),anyDirection));
-      TransverseImpactPointExtrapolator tipExtrapolator(gsfProp);
-      fillMode(track,innertsos,gsfProp,tipExtrapolator,tscblBuilder,bs);
+      if ( !gsfProp ) {
+	gsfProp.reset(new GsfPropagatorAdapter(AnalyticalPropagator(innertsos.magneticField(),anyDirection)));
+	tipExtrapolator.reset(new TransverseImpactPointExtrapolator(*gsfProp));
+      }
+      fillMode(track,innertsos,*gsfProp,*tipExtrapolator,tscblBuilder,bs);
     }
 
-    delete theTrack;
-    delete theTraj;
+    // the trajectory is not used anymore: move it into the output, or free its measurements now
+    if(trajectoryInEvent_) {
+      selTrajectories->push_back( std::move(*theTraj) );
+      iTjRef++;
+      // Store indices in local map (starts at 0)
+      tjTkMap[iTjRef-1] = iTkRef-1;
+    } else {
+      *theTraj = Trajectory();   // frees the measurements
+    }
   }
 
   LogTrace("TrackingRegressionTest") << "========== TrackProducer Info ===================";
@@ -224,7 +234,8 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
   LogTrace("TrackingRegressionTest") << "=================================================";
   
 
-  rTracks_ = evt.put( selTracks );
+  edm::OrphanHandle<reco::GsfTrackCollection> rTracks = evt.put( selTracks );
+  rTracks_ = rTracks;
   evt.put( selTrackExtras );
   evt.put( selGsfTrackExtras );
   evt.put( selHits );
@@ -237,12 +248,13 @@ GsfTrackProducerBase::putInEvt(edm::Event& evt,
     for ( std::map<unsigned int, unsigned int>::iterator i = tjTkMap.begin(); 
 	  i != tjTkMap.end(); i++ ) {
       edm::Ref<std::vector<Trajectory> > trajRef( rTrajs, (*i).first );
-      edm::Ref<reco::GsfTrackCollection>    tkRef( rTracks_, (*i).second );
+      edm::Ref<reco::GsfTrackCollection>    tkRef( rTracks, (*i).second );
       trajTrackMap->insert( edm::Ref<std::vector<Trajectory> >( rTrajs, (*i).first ),
-			    edm::Ref<reco::GsfTrackCollection>( rTracks_, (*i).second ) );
+			    edm::Ref<reco::GsfTrackCollection>( rTracks, (*i).second ) );
     }
     evt.put( trajTrackMap );
   }
+  return rTracks;
 }
 
 void
@@ -280,9 +292,23 @@ GsfTrackProducerBase::fillMode (reco::GsfTrack& track, const TrajectoryStateOnSu
   // build perigee parameters (for covariance to be stored)
   AlgebraicVector5 modeParameters;
   AlgebraicSymMatrix55 modeCovariance;
-  // set parameters and variances for "mode" state (local parameters)
+  // set parameters and variances for "mode" state (local parameters):
+  //   the components are extracted once and the five 1D mixtures filled in one pass
+  //   (invalid components are skipped, as in MultiGaussianStateTransform::multiState1D)
+  std::vector<TrajectoryStateOnSurface> components(vtxTsos.components());
+  std::vector<SingleGaussianState1D> states1D[5];
+  for ( unsigned int iv=0; iv<5; ++iv )  states1D[iv].reserve(components.size());
+  for ( std::vector<TrajectoryStateOnSurface>::const_iterator ic=components.begin();
+	ic!=components.end(); ++ic ) {
+    if ( !ic->isValid() )  continue;
+    AlgebraicVector5 pars = ic->localParameters().vector();
+    const AlgebraicSymMatrix55& errs = ic->localError().matrix();
+    double weight = ic->weight();
+    for ( unsigned int iv=0; iv<5; ++iv )
+      states1D[iv].push_back(SingleGaussianState1D(pars(iv),errs(iv,iv),weight));
+  }
   for ( unsigned int iv=0; iv<5; ++iv ) {
-    MultiGaussianState1D state1D = MultiGaussianStateTransform::multiState1D(vtxTsos,iv);
+    MultiGaussianState1D state1D(states1D[iv]);
     GaussianSumUtilities1D utils(state1D);
     modeParameters(iv) = utils.mode().mean();
     modeCovariance(iv,iv) = utils.mode().variance();
@@ -291,6 +317,7 @@ GsfTrackProducerBase::fillMode (reco::GsfTrack& track, const TrajectoryStateOnSu
       modeParameters(iv) = utils.mean();
       modeCovariance(iv,iv) = utils.variance();
     }
+    if ( validateMode_ )  checkMode(vtxTsos,iv,modeParameters(iv),modeCovariance(iv,iv));
   }
   // complete covariance matrix
   // approximation: use correlations from mean
@@ -327,6 +354,22 @@ GsfTrackProducerBase::fillMode (reco::GsfTrack& track, const TrajectoryStateOnSu
   track.setMode(fts.charge(),mom,cov);
 }
 
+void
+GsfTrackProducerBase::checkMode (const TrajectoryStateOnSurface& tsos, unsigned int iv,
+				 double mode, double variance) const
+{
+  MultiGaussianState1D state1D = MultiGaussianStateTransform::multiState1D(tsos,iv);
+  GaussianSumUtilities1D utils(state1D);
+  double refMode = utils.modeIsValid() ? utils.mode().mean() : utils.mean();
+  double refVariance = utils.modeIsValid() ? utils.mode().variance() : utils.variance();
+  const double tolerance = 1.e-9;
+  if ( fabs(mode-refMode)>tolerance*std::max(1.,fabs(refMode)) ||
+       fabs(variance-refVariance)>tolerance*std::max(1.,fabs(refVariance)) ) {
+    edm::LogWarning("GsfTrackProducer") << "mode of local parameter " << iv << " differs from the per-parameter result: "
+					<< mode << " +- " << variance << " instead of " << refMode << " +- " << refVariance;
+  }
+}
+
 void
 GsfTrackProducerBase::localParametersFromQpMode (const TrajectoryStateOnSurface tsos,
 						 AlgebraicVector5& parameters,
@@ -6,6 +6,7 @@
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "TrackingTools/GeomPropagators/interface/Propagator.h"
 #include "TrackingTools/PatternTools/interface/Trajectory.h"
 
@@ -16,15 +17,22 @@
 #include "RecoTracker/TrackProducer/interface/ClusterRemovalRefSetter.h"
 #include "TrajectoryToResiduals.h"
 
-void KfTrackProducerBase::putInEvt(edm::Event& evt,
-				   const Propagator* prop,
-				   const MeasurementTracker* measTk,
-				   std::auto_ptr<TrackingRecHitCollection>& selHits,
-				   std::auto_ptr<reco::TrackCollection>& selTracks,
-				   std::auto_ptr<reco::TrackExtraCollection>& selTrackExtras,
-				   std::auto_ptr<std::vector<Trajectory> >&   selTrajectories,
-				   AlgoProductCollection& algoResults)
+edm::OrphanHandle<reco::TrackCollection>
+KfTrackProducerBase::putInEvt(edm::Event& evt,
+			      const Propagator* prop,
+			      const MeasurementTracker* measTk,
+			      std::auto_ptr<TrackingRecHitCollection>& selHits,
+			      std::auto_ptr<reco::TrackCollection>& selTracks,
+			      std::auto_ptr<reco::TrackExtraCollection>& selTrackExtras,
+			      std::auto_ptr<std::vector<Trajectory> >&   selTrajectories,
+			      AlgoProductCollection& algoResults)
 {
+  TrackProducerProfiler::Timer timer(&profiler_,TrackProducerProfiler::putInEvt);
+
+  if (tracksOnly_) {
+    setSecondHitPatterns(algoResults,prop,measTk);
+    return putTracksOnly(evt,selTracks,algoResults);
+  }
 
   TrackingRecHitRefProd rHits = evt.getRefBeforePut<TrackingRecHitCollection>();
   reco::TrackExtraRefProd rTrackExtras = evt.getRefBeforePut<reco::TrackExtraCollection>();
@@ -35,17 +43,28 @@ void KfTrackProducerBase::putInEvt(edm::Event& evt,
   edm::Ref< std::vector<Trajectory> >::key_type iTjRef = 0;
   std::map<unsigned int, unsigned int> tjTkMap;
 
+  // no reallocation: every Trajectory is moved exactly once
+  if(trajectoryInEvent_) selTrajectories->reserve(selTrajectories->size()+algoResults.size());
+  // one allocation per output collection (split hits may still add a few)
+  size_t nMeasurements = 0;
+  for(AlgoProductCollection::const_iterator i=algoResults.begin(); i!=algoResults.end();i++)
+    nMeasurements += (*i).first.measurements().size();
+  selTracks->reserve(selTracks->size()+algoResults.size());
+  selTrackExtras->reserve(selTrackExtras->size()+algoResults.size());
+  selHits->reserve(selHits->size()+nMeasurements);
+
+  // second hit pattern: filled on the fitted tracks before they are moved to the output
+  setSecondHitPatterns(algoResults,prop,measTk);
+
   for(AlgoProductCollection::iterator i=algoResults.begin(); i!=algoResults.end();i++){
-    Trajectory * theTraj = (*i).first;
-    if(trajectoryInEvent_) {
-      selTrajectories->push_back(*theTraj);
-      iTjRef++;
-    }
+    Trajectory * theTraj = &(*i).first;
 
-    // const TrajectoryFitter::RecHitContainer& transHits = theTraj->recHits(useSplitting);  // NO: the return type in Trajectory is by VALUE
-    TrajectoryFitter::RecHitContainer transHits = theTraj->recHits(useSplitting);
+    // Trajectory::recHits() returns by VALUE: only build the container when the hits must be split,
+    // otherwise the measurements are walked in place
+    TrajectoryFitter::RecHitContainer splitHits;
+    if (useSplitting) splitHits = theTraj->recHits(true);
 
-    reco::Track * theTrack = (*i).second.first;
+    reco::Track & theTrack = (*i).second.first;
     
     // Hits are going to be re-sorted along momentum few lines later. 
     // Therefore the direction stored in the TrackExtra 
@@ -56,12 +75,8 @@ void KfTrackProducerBase::putInEvt(edm::Event& evt,
 
     LogDebug("TrackProducer") << "In KfTrackProducerBase::putInEvt - seedDir=" << seedDir;
 
-    reco::Track t = * theTrack;
-    selTracks->push_back( t );
+    selTracks->push_back( std::move(theTrack) );
     iTkRef++;
-
-    // Store indices in local map (starts at 0)
-    if(trajectoryInEvent_) tjTkMap[iTjRef-1] = iTkRef-1;
     
     //sets the outermost and innermost TSOSs
     TrajectoryStateOnSurface outertsos;
@@ -96,14 +111,6 @@ void KfTrackProducerBase::putInEvt(edm::Event& evt,
     reco::Track & track = selTracks->back();
     track.setExtra( teref );
     
-    //======= I want to set the second hitPattern here =============
-    if (theSchool.isValid())
-      {
-	NavigationSetter setter( *theSchool );
-	setSecondHitPattern(theTraj,track,prop,measTk);
-      }
-    //==============================================================
-    
     selTrackExtras->push_back( reco::TrackExtra (outpos, outmom, true, inpos, inmom, true,
 						 outertsos.curvilinearError(), outerId,
 						 innertsos.curvilinearError(), innerId,
@@ -115,40 +122,39 @@ void KfTrackProducerBase::putInEvt(edm::Event& evt,
     // ---  NOTA BENE: the convention is to sort hits and measurements "along the momentum".
     // This is consistent with innermost and outermost labels only for tracks from LHC collisions
     size_t ih = 0;
-    if (theTraj->direction() == alongMomentum) {
-      for( TrajectoryFitter::RecHitContainer::const_iterator j = transHits.begin();
-	   j != transHits.end(); j ++ ) {
-	if ((**j).hit()!=0){
-	  TrackingRecHit * hit = (**j).hit()->clone();
-	  track.setHitPattern( * hit, ih ++ );
-	  selHits->push_back( hit );
-	  tx.add( TrackingRecHitRef( rHits, hidx ++ ) );
-	}
-      }
-    }else{
-      for( TrajectoryFitter::RecHitContainer::const_iterator j = transHits.end()-1;
-	   j != transHits.begin()-1; --j ) {
-	if ((**j).hit()!=0){
-	  TrackingRecHit * hit = (**j).hit()->clone();
-	  track.setHitPattern( * hit, ih ++ );
-	  selHits->push_back( hit );
+    const Trajectory::DataContainer & measurements = theTraj->measurements();
+    const size_t nHits = useSplitting ? splitHits.size() : measurements.size();
+    const bool along = (theTraj->direction() == alongMomentum);
+    for (size_t j = 0; j != nHits; ++j) {
+      const size_t k = along ? j : nHits-1-j;
+      const TrackingRecHit * trackHit = useSplitting ? splitHits[k]->hit() : measurements[k].recHitR().hit();
+      if (trackHit!=0){
+	TrackingRecHit * hit = trackHit->clone();
+	track.setHitPattern( * hit, ih ++ );
+	selHits->push_back( hit );
 	tx.add( TrackingRecHitRef( rHits, hidx ++ ) );
-	}
       }
     }
     // ----
-    tx.setResiduals(trajectoryToResiduals(*theTraj));
+    if (fillResiduals_) tx.setResiduals(trajectoryToResiduals(*theTraj,residualType_));
 
-    delete theTrack;
-    delete theTraj;
+    // the trajectory is not used anymore: move it (with all its measurements) into the output,
+    // or free them now rather than when the whole collection goes out of scope
+    if(trajectoryInEvent_) {
+      selTrajectories->push_back( std::move(*theTraj) );
+      iTjRef++;
+      // Store indices in local map (starts at 0)
+      tjTkMap[iTjRef-1] = iTkRef-1;
+    } else {
+      *theTraj = Trajectory();   // frees the measurements
+    }
   }
 
   // Now we can re-set refs to hits, as they have already been cloned
   if (rekeyClusterRefs_) {
+      TrackProducerProfiler::Timer reKeyTimer(&profiler_,TrackProducerProfiler::reKey);
       ClusterRemovalRefSetter refSetter(evt, clusterRemovalInfo_);
-      for (TrackingRecHitCollection::iterator it = selHits->begin(), ed = selHits->end(); it != ed; ++it) {
-          refSetter.reKey(&*it);
-      }
+      refSetter.reKey(*selHits);
   }
 
   LogTrace("TrackingRegressionTest") << "========== TrackProducer Info ===================";
@@ -164,7 +170,8 @@ void KfTrackProducerBase::putInEvt(edm::Event& evt,
   LogTrace("TrackingRegressionTest") << "=================================================";
   
   
-  rTracks_ = evt.put( selTracks );
+  edm::OrphanHandle<reco::TrackCollection> rTracks = evt.put( selTracks );
+  rTracks_ = rTracks;
   evt.put( selTrackExtras );
   evt.put( selHits );
 
@@ -176,11 +183,50 @@ void KfTrackProducerBase::putInEvt(edm::Event& evt,
     for ( std::map<unsigned int, unsigned int>::iterator i = tjTkMap.begin(); 
           i != tjTkMap.end(); i++ ) {
       edm::Ref<std::vector<Trajectory> > trajRef( rTrajs, (*i).first );
-      edm::Ref<reco::TrackCollection>    tkRef( rTracks_, (*i).second );
+      edm::Ref<reco::TrackCollection>    tkRef( rTracks, (*i).second );
       trajTrackMap->insert( edm::Ref<std::vector<Trajectory> >( rTrajs, (*i).first ),
-                            edm::Ref<reco::TrackCollection>( rTracks_, (*i).second ) );
+                            edm::Ref<reco::TrackCollection>( rTracks, (*i).second ) );
     }
     evt.put( trajTrackMap );
   }
+  return rTracks;
 }
 
+edm::OrphanHandle<reco::TrackCollection>
+KfTrackProducerBase::putTracksOnly(edm::Event& evt,
+				   std::auto_ptr<reco::TrackCollection>& selTracks,
+				   AlgoProductCollection& algoResults)
+{
+  selTracks->reserve(selTracks->size()+algoResults.size());
+
+  for(AlgoProductCollection::iterator i=algoResults.begin(); i!=algoResults.end();i++){
+    const Trajectory & theTraj = (*i).first;
+    selTracks->push_back( std::move((*i).second.first) );
+    reco::Track & track = selTracks->back();
+
+    // same hits and order as in the full output, set from the hits of the trajectory
+    TrajectoryFitter::RecHitContainer splitHits;
+    if (useSplitting) splitHits = theTraj.recHits(true);
+    size_t ih = 0;
+    const Trajectory::DataContainer & measurements = theTraj.measurements();
+    const size_t nHits = useSplitting ? splitHits.size() : measurements.size();
+    const bool along = (theTraj.direction() == alongMomentum);
+    for (size_t j = 0; j != nHits; ++j) {
+      const size_t k = along ? j : nHits-1-j;
+      const TrackingRecHit * trackHit = useSplitting ? splitHits[k]->hit() : measurements[k].recHitR().hit();
+      if (trackHit!=0) track.setHitPattern( *trackHit, ih ++ );
+    }
+  }
+
+  rTracks_ = evt.put( selTracks );
+  return rTracks_;
+}
+
+void KfTrackProducerBase::setResiduals(const std::string& type)
+{
+  if (type == "off") fillResiduals_ = false;
+  else if (type == "X_Y_RESIDUALS") { fillResiduals_ = true; residualType_ = reco::TrackResiduals::X_Y_RESIDUALS; }
+  else if (type == "X_Y_PULLS") { fillResiduals_ = true; residualType_ = reco::TrackResiduals::X_Y_PULLS; }
+  else throw cms::Exception("TrackProducer") 
+    << "unknown residuals " << type << "! Set it to 'off', 'X_Y_RESIDUALS' or 'X_Y_PULLS'";
+}
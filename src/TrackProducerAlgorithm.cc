@@ -29,49 +29,23 @@
 #include "TrackingTools/TrackFitters/interface/RecHitSorter.h"
 #include "DataFormats/TrackReco/interface/TrackBase.h"
 
-namespace {
-#ifdef STAT_TSB
-  struct StatCount {
-    long long totTrack=0;
-    long long totLoop=0;
-    long long totGsfTrack=0;
-    long long totFound=0;
-    long long totLost=0;
-    long long totAlgo[12];
-    void track(int l) {
-      if (l>0) ++totLoop; else ++totTrack;
-    }
-    void hits(int f, int l) { totFound+=f; totLost+=l;} 
-    void gsf() {++totGsfTrack;}
-    void algo(int a) { if (a>=0 && a<12) ++totAlgo[a];}
-
+#include <tuple>
 
-    void print() const {
-      std::cout << "TrackProducer stat\nTrack/Loop/Gsf/FoundHits/LostHits/algos "
-    		<<  totTrack <<'/'<< totLoop <<'/'<< totGsfTrack  <<'/'<< totFound  <<'/'<< totLost;
-      for (auto a : totAlgo) std::cout << '/'<< a;
-	std::cout  << std::endl;
+namespace {
+  // sum of dimension*weight of the valid hits (weights < 1 from DAF-like fitters), minus the 5 track parameters
+  inline float trajectoryNdof(const Trajectory & traj, const MagneticField * field) {
+    const Trajectory::DataContainer & measurements = traj.measurements();
+    float ndof = 0;
+    for (Trajectory::DataContainer::const_iterator tm=measurements.begin(); tm!=measurements.end(); ++tm) {
+      const TransientTrackingRecHit & h = tm->recHitR();
+      if (h.isValid()) ndof += float(h.dimension())*h.weight();  // two virtual calls: the hits do not cache them
     }
-    StatCount() {}
-    ~StatCount() { print();}
-  };
-
-#else
-  struct StatCount {
-    void track(int){}
-    void hits(int, int){}
-    void gsf(){}
-    void algo(int){}
-  };
-#endif
-
-  StatCount statCount;
-
+    ndof -= 5.f;
+    if unlikely(std::abs(field->nominalValue())<DBL_MIN) ++ndof;  // same as -4
+    return ndof;
+  }
 }
 
-
-
-
 template <> bool
 TrackProducerAlgorithm<reco::Track>::buildTrack (const TrajectoryFitter * theFitter,
 						 const Propagator * thePropagator,
@@ -81,25 +55,20 @@ TrackProducerAlgorithm<reco::Track>::buildTrack (const TrajectoryFitter * theFit
 						 const TrajectorySeed& seed,
 						 float ndof,
 						 const reco::BeamSpot& bs,
+						 reco::TrackBase::TrackAlgorithm algo,
 						 SeedRef seedRef,
 						 int qualityMask,signed char nLoops)						 
 {
   //variable declarations
-  reco::Track * theTrack;
-  Trajectory * theTraj; 
   PropagationDirection seedDir = seed.direction();
       
   //perform the fit: the result's size is 1 if it succeded, 0 if fails
-  Trajectory && trajTmp = theFitter->fitOne(seed, hits, theTSOS,(nLoops>0) ? TrajectoryFitter::looper : TrajectoryFitter::standard);
-  if unlikely(!trajTmp.isValid()) return false;
+  TrackProducerProfiler::Timer fitTimer(profiler_,TrackProducerProfiler::fit);
+  Trajectory && theTraj = theFitter->fitOne(seed, hits, theTSOS,(nLoops>0) ? TrajectoryFitter::looper : TrajectoryFitter::standard);
+  fitTimer.stop();
+  if unlikely(!theTraj.isValid()) return false;
   
-  
-  
-  theTraj = new Trajectory(std::move(trajTmp));
-  theTraj->setSeedRef(seedRef);
-  
-  statCount.hits(theTraj->foundHits(),theTraj->lostHits());
-  statCount.algo(int(algo_));
+  theTraj.setSeedRef(seedRef);
 
   // TrajectoryStateOnSurface innertsos;
   // if (theTraj->direction() == alongMomentum) {
@@ -108,71 +77,67 @@ TrackProducerAlgorithm<reco::Track>::buildTrack (const TrajectoryFitter * theFit
   //  innertsos = theTraj->lastMeasurement().updatedState();
   // }
   
-  ndof = 0;
-  for (auto const & tm : theTraj->measurements()) {
-    auto const & h = tm.recHitR();
-    if (h.isValid()) ndof = ndof + float(h.dimension())*h.weight();  // two virtual calls!
-  }
-  
-  ndof -= 5.f;
-  if unlikely(std::abs(theTSOS.magneticField()->nominalValue())<DBL_MIN) ++ndof;  // same as -4
+  ndof = trajectoryNdof(theTraj,theTSOS.magneticField());
  
  
   //if geometricInnerState_ is false the state for projection to beam line is the state attached to the first hit: to be used for loopers
   //if geometricInnerState_ is true the state for projection to beam line is the one from the (geometrically) closest measurement to the beam line: to be sued for non-collision tracks
   //the two shouuld give the same result for collision tracks that are NOT loopers
+  TrackProducerProfiler::Timer beamLineTimer(profiler_,TrackProducerProfiler::beamLine);
   TrajectoryStateOnSurface stateForProjectionToBeamLineOnSurface;
   if (geometricInnerState_) {
-    stateForProjectionToBeamLineOnSurface = theTraj->closestMeasurement(GlobalPoint(bs.x0(),bs.y0(),bs.z0())).updatedState();
+    stateForProjectionToBeamLineOnSurface = theTraj.closestMeasurement(GlobalPoint(bs.x0(),bs.y0(),bs.z0())).updatedState();
   } else {
-    if (theTraj->direction() == alongMomentum) {
-      stateForProjectionToBeamLineOnSurface = theTraj->firstMeasurement().updatedState();
+    if (theTraj.direction() == alongMomentum) {
+      stateForProjectionToBeamLineOnSurface = theTraj.firstMeasurement().updatedState();
     } else { 
-      stateForProjectionToBeamLineOnSurface = theTraj->lastMeasurement().updatedState();
+      stateForProjectionToBeamLineOnSurface = theTraj.lastMeasurement().updatedState();
     }
   }
 
   if unlikely(!stateForProjectionToBeamLineOnSurface.isValid()){
     edm::LogError("CannotPropagateToBeamLine")<<"the state on the closest measurement isnot valid. skipping track.";
-    delete theTraj;
     return false;
   }
   const FreeTrajectoryState & stateForProjectionToBeamLine=*stateForProjectionToBeamLineOnSurface.freeState();
   
   LogDebug("TrackProducer") << "stateForProjectionToBeamLine=" << stateForProjectionToBeamLine;
   
-  TSCBLBuilderNoMaterial tscblBuilder;
-  TrajectoryStateClosestToBeamLine tscbl = tscblBuilder(stateForProjectionToBeamLine,bs);
+  TrajectoryStateClosestToBeamLine tscbl = tscblBuilder_(stateForProjectionToBeamLine,bs);
   
   if unlikely(!tscbl.isValid()) {
-    delete theTraj;
     return false;
   }
+  beamLineTimer.stop();
   
-  GlobalPoint v = tscbl.trackStateAtPCA().position();
+  const FreeTrajectoryState & stateAtPCA = tscbl.trackStateAtPCA();
+  GlobalPoint v = stateAtPCA.position();
   math::XYZPoint  pos( v.x(), v.y(), v.z() );
-  GlobalVector p = tscbl.trackStateAtPCA().momentum();
+  GlobalVector p = stateAtPCA.momentum();
   math::XYZVector mom( p.x(), p.y(), p.z() );
   
   LogDebug("TrackProducer") << "pos=" << v << " mom=" << p << " pt=" << p.perp() << " mag=" << p.mag();
   
-  theTrack = new reco::Track(theTraj->chiSquared(),
-			     int(ndof),//FIXME fix weight() in TrackingRecHit
-			     pos, mom, tscbl.trackStateAtPCA().charge(), 
-			     tscbl.trackStateAtPCA().curvilinearError(),
-			     algo_);
+  reco::Track theTrack(theTraj.chiSquared(),
+		       ndof,
+		       pos, mom, stateAtPCA.charge(), 
+		       stateAtPCA.curvilinearError(),
+		       algo);
   
-  theTrack->setQualityMask(qualityMask);
-  theTrack->setNLoops(nLoops);
+  theTrack.setQualityMask(qualityMask);
+  theTrack.setNLoops(nLoops);
   
-  LogDebug("TrackProducer") << "theTrack->pt()=" << theTrack->pt();
+  LogDebug("TrackProducer") << "theTrack.pt()=" << theTrack.pt();
   
   LogDebug("TrackProducer") <<"track done\n";
   
-  AlgoProduct aProduct(theTraj,std::make_pair(theTrack,seedDir));
-  algoResults.push_back(aProduct);
-  
-  statCount.track(nLoops);
+  // the hit pattern is only filled in putInEvt: count the hits of the trajectory
+  if (profiler_) profiler_->countTrack(int(algo),nLoops,theTraj.foundHits(),theTraj.lostHits());
+
+  // the product holds trajectory and track by value: the fitted Trajectory is moved in, no heap copy
+  algoResults.emplace_back(std::piecewise_construct,
+			   std::forward_as_tuple(std::move(theTraj)),
+			   std::forward_as_tuple(theTrack,seedDir));
 
   return true;
 } 
@@ -186,20 +151,19 @@ TrackProducerAlgorithm<reco::GsfTrack>::buildTrack (const TrajectoryFitter * the
 						    const TrajectorySeed& seed,
 						    float ndof,
 						    const reco::BeamSpot& bs,
+						    reco::TrackBase::TrackAlgorithm algo,
 						    SeedRef seedRef,
 						    int qualityMask,signed char nLoops)
 {
   //variable declarations
-  reco::GsfTrack * theTrack;
-  Trajectory * theTraj; 
   PropagationDirection seedDir = seed.direction();
   
-  Trajectory && trajTmp = theFitter->fitOne(seed, hits, theTSOS,(nLoops>0) ? TrajectoryFitter::looper: TrajectoryFitter::standard);
-  if unlikely(!trajTmp.isValid()) return false;
-  
+  TrackProducerProfiler::Timer fitTimer(profiler_,TrackProducerProfiler::fit);
+  Trajectory && theTraj = theFitter->fitOne(seed, hits, theTSOS,(nLoops>0) ? TrajectoryFitter::looper: TrajectoryFitter::standard);
+  fitTimer.stop();
+  if unlikely(!theTraj.isValid()) return false;
   
-  theTraj = new Trajectory( std::move(trajTmp) );
-  theTraj->setSeedRef(seedRef);
+  theTraj.setSeedRef(seedRef);
   
   //  TrajectoryStateOnSurface innertsos;
   // TrajectoryStateOnSurface outertsos;
@@ -227,33 +191,26 @@ TrackProducerAlgorithm<reco::GsfTrack>::buildTrack (const TrajectoryFitter * the
   // 		<< sqrt((*ic).localError().matrix()[0][0])/sinTheta << std::endl;
   //     }
   
-  ndof = 0;
-  for (auto const & tm : theTraj->measurements()) {
-    auto const & h = tm.recHitR();
-    if (h.isValid()) ndof = ndof + h.dimension()*h.weight();
-  }
-  
-  ndof = ndof - 5;
-  if unlikely(std::abs(theTSOS.magneticField()->nominalValue())<DBL_MIN) ++ndof;  // same as -4
+  ndof = trajectoryNdof(theTraj,theTSOS.magneticField());
   
   
   //if geometricInnerState_ is false the state for projection to beam line is the state attached to the first hit: to be used for loopers
   //if geometricInnerState_ is true the state for projection to beam line is the one from the (geometrically) closest measurement to the beam line: to be sued for non-collision tracks
   //the two shouuld give the same result for collision tracks that are NOT loopers
+  TrackProducerProfiler::Timer beamLineTimer(profiler_,TrackProducerProfiler::beamLine);
   TrajectoryStateOnSurface stateForProjectionToBeamLineOnSurface;
   if (geometricInnerState_) {
-    stateForProjectionToBeamLineOnSurface = theTraj->closestMeasurement(GlobalPoint(bs.x0(),bs.y0(),bs.z0())).updatedState();
+    stateForProjectionToBeamLineOnSurface = theTraj.closestMeasurement(GlobalPoint(bs.x0(),bs.y0(),bs.z0())).updatedState();
   } else {
-    if (theTraj->direction() == alongMomentum) {
-      stateForProjectionToBeamLineOnSurface = theTraj->firstMeasurement().updatedState();
+    if (theTraj.direction() == alongMomentum) {
+      stateForProjectionToBeamLineOnSurface = theTraj.firstMeasurement().updatedState();
     } else { 
-      stateForProjectionToBeamLineOnSurface = theTraj->lastMeasurement().updatedState();
+      stateForProjectionToBeamLineOnSurface = theTraj.lastMeasurement().updatedState();
     }
   }
 
   if unlikely(!stateForProjectionToBeamLineOnSurface.isValid()){
       edm::LogError("CannotPropagateToBeamLine")<<"the state on the closest measurement isnot valid. skipping track.";
-      delete theTraj;
       return false;
     }    
   
@@ -261,36 +218,37 @@ TrackProducerAlgorithm<reco::GsfTrack>::buildTrack (const TrajectoryFitter * the
   
   LogDebug("GsfTrackProducer") << "stateForProjectionToBeamLine=" << stateForProjectionToBeamLine;
   
-  TSCBLBuilderNoMaterial tscblBuilder;
-  TrajectoryStateClosestToBeamLine tscbl = tscblBuilder(stateForProjectionToBeamLine,bs);
+  TrajectoryStateClosestToBeamLine tscbl = tscblBuilder_(stateForProjectionToBeamLine,bs);
   
   if unlikely(tscbl.isValid()==false) {
-      delete theTraj;
       return false;
     }
+  beamLineTimer.stop();
   
-  GlobalPoint v = tscbl.trackStateAtPCA().position();
+  const FreeTrajectoryState & stateAtPCA = tscbl.trackStateAtPCA();
+  GlobalPoint v = stateAtPCA.position();
   math::XYZPoint  pos( v.x(), v.y(), v.z() );
-  GlobalVector p = tscbl.trackStateAtPCA().momentum();
+  GlobalVector p = stateAtPCA.momentum();
   math::XYZVector mom( p.x(), p.y(), p.z() );
   
   LogDebug("GsfTrackProducer") << "pos=" << v << " mom=" << p << " pt=" << p.perp() << " mag=" << p.mag();
   
-  theTrack = new reco::GsfTrack(theTraj->chiSquared(),
-				int(ndof),//FIXME fix weight() in TrackingRecHit
-				//			       theTraj->foundHits(),//FIXME to be fixed in Trajectory.h
-				//			       0, //FIXME no corresponding method in trajectory.h
-				//			       theTraj->lostHits(),//FIXME to be fixed in Trajectory.h
-				pos, mom, tscbl.trackStateAtPCA().charge(), tscbl.trackStateAtPCA().curvilinearError());    
-  theTrack->setAlgorithm(algo_);
+  reco::GsfTrack theTrack(theTraj.chiSquared(),
+			  ndof,
+			  //			       theTraj->foundHits(),//FIXME to be fixed in Trajectory.h
+			  //			       0, //FIXME no corresponding method in trajectory.h
+			  //			       theTraj->lostHits(),//FIXME to be fixed in Trajectory.h
+			  pos, mom, stateAtPCA.charge(), stateAtPCA.curvilinearError());    
+  theTrack.setAlgorithm(algo);
   
   LogDebug("GsfTrackProducer") <<"track done\n";
   
-  AlgoProduct aProduct(theTraj,std::make_pair(theTrack,seedDir));
+  algoResults.emplace_back(std::piecewise_construct,
+			   std::forward_as_tuple(std::move(theTraj)),
+			   std::forward_as_tuple(theTrack,seedDir));
   LogDebug("GsfTrackProducer") <<"track done1\n";
-  algoResults.push_back(aProduct);
   LogDebug("GsfTrackProducer") <<"track done2\n";
   
-  statCount.gsf();
+  if (profiler_) profiler_->countGsfTrack(int(algo));
   return true;
 } 
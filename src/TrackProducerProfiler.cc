@@ -0,0 +1,80 @@
+#include "RecoTracker/TrackProducer/interface/TrackProducerProfiler.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+#include <sstream>
+
+TrackProducerProfiler::TrackProducerProfiler() : enabled_(false) {
+  for (unsigned int s=0; s!=nStages; ++s) {
+    calls_[s].store(0);
+    totalNs_[s].store(0);
+    for (unsigned int b=0; b!=nBins; ++b) histogram_[s][b].store(0);
+  }
+  for (unsigned int a=0; a!=nAlgos; ++a) {
+    tracks_[a].store(0);
+    loopers_[a].store(0);
+    gsfTracks_[a].store(0);
+    foundHits_[a].store(0);
+    lostHits_[a].store(0);
+  }
+}
+
+void TrackProducerProfiler::fill(Stage stage, long long ns) {
+  unsigned int bin = (ns>0) ? 64-__builtin_clzll(ns) : 0;
+  if (bin>=nBins) bin = nBins-1;
+  calls_[stage].fetch_add(1,std::memory_order_relaxed);
+  totalNs_[stage].fetch_add(ns,std::memory_order_relaxed);
+  histogram_[stage][bin].fetch_add(1,std::memory_order_relaxed);
+}
+
+void TrackProducerProfiler::countTrack(int algo, signed char nLoops, int foundHits, int lostHits) {
+  if (!enabled_ || algo<0 || algo>=int(nAlgos)) return;
+  if (nLoops>0) loopers_[algo].fetch_add(1,std::memory_order_relaxed);
+  else tracks_[algo].fetch_add(1,std::memory_order_relaxed);
+  foundHits_[algo].fetch_add(foundHits,std::memory_order_relaxed);
+  lostHits_[algo].fetch_add(lostHits,std::memory_order_relaxed);
+}
+
+void TrackProducerProfiler::countGsfTrack(int algo) {
+  if (!enabled_ || algo<0 || algo>=int(nAlgos)) return;
+  gsfTracks_[algo].fetch_add(1,std::memory_order_relaxed);
+}
+
+const char* TrackProducerProfiler::stageName(Stage stage) {
+  switch (stage) {
+  case hitBuilding:      return "hitBuilding";
+  case fit:              return "fit";
+  case beamLine:         return "beamLine";
+  case putInEvt:         return "putInEvt";
+  case secondHitPattern: return "secondHitPattern";
+  case reKey:            return "reKey";
+  default:               return "unknown";
+  }
+}
+
+void TrackProducerProfiler::print(std::ostream& os) const {
+  for (unsigned int s=0; s!=nStages; ++s) {
+    long long calls = calls_[s].load();
+    if (calls==0) continue;
+    long long total = totalNs_[s].load();
+    os << "label=" << label_ << " stage=" << stageName(Stage(s))
+       << " calls=" << calls << " total_ns=" << total << " mean_ns=" << total/calls
+       << " log2_ns_histogram=";
+    for (unsigned int b=0; b!=nBins; ++b) os << (b ? "," : "") << histogram_[s][b].load();
+    os << "\n";
+  }
+  for (unsigned int a=0; a!=nAlgos; ++a) {
+    long long tracks = tracks_[a].load(), loopers = loopers_[a].load(), gsf = gsfTracks_[a].load();
+    if (tracks+loopers+gsf==0) continue;
+    os << "label=" << label_ << " algo=" << reco::TrackBase::algoName(reco::TrackBase::TrackAlgorithm(a))
+       << " tracks=" << tracks << " loopers=" << loopers << " gsfTracks=" << gsf
+       << " foundHits=" << foundHits_[a].load() << " lostHits=" << lostHits_[a].load() << "\n";
+  }
+}
+
+void TrackProducerProfiler::dump() const {
+  if (!enabled_) return;
+  std::ostringstream os;
+  print(os);
+  edm::LogVerbatim("TrackProducerProfile") << os.str();
+}
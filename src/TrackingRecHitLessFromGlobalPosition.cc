@@ -1,66 +1,59 @@
 #include "RecoTracker/TrackProducer/interface/TrackingRecHitLessFromGlobalPosition.h"
 
-#include "FWCore/Utilities/interface/Exception.h"
-#include "DataFormats/SiStripDetId/interface/StripSubdetector.h"
-#include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
+#include "RecoTracker/TrackProducer/interface/TrackerSubdetInfo.h"
+#include "RecoTracker/TrackProducer/interface/TrackingRecHitSortByKey.h"
 
-bool TrackingRecHitLessFromGlobalPosition::insideOutLess(  const TrackingRecHit& a, const TrackingRecHit& b) const{
-  
-  DetId ida(a.geographicalId());
-  DetId idb(b.geographicalId());
+#include <cmath>
 
-  unsigned int idetA = static_cast<unsigned int>(ida.subdetId());
-  unsigned int idetB = static_cast<unsigned int>(idb.subdetId());
+TrackingRecHitLessFromGlobalPosition::Key
+TrackingRecHitLessFromGlobalPosition::key( const TrackingRecHit& hit) const{
 
-  //check for mixed case...
-  bool same_det = ( 
-		   (idetA == StripSubdetector::TIB && idetB == StripSubdetector::TIB) ||
-		   (idetA == StripSubdetector::TID && idetB == StripSubdetector::TID) ||
-		   (idetA == StripSubdetector::TIB && idetB == StripSubdetector::TID) ||
-		   (idetA == StripSubdetector::TID && idetB == StripSubdetector::TIB) ||
+  DetId id(hit.geographicalId());
+  Key k;
+  k.subdet = static_cast<unsigned int>(id.subdetId());
 
-		   (idetA == StripSubdetector::TOB && idetB == StripSubdetector::TOB) ||
-		   (idetA == StripSubdetector::TEC && idetB == StripSubdetector::TEC) ||
-		   (idetA == StripSubdetector::TOB && idetB == StripSubdetector::TEC) ||
-		   (idetA == StripSubdetector::TEC && idetB == StripSubdetector::TOB) ||
+  //mixed barrel/forward pairs are only compared within the same part of the tracker
+  const TrackerSubdetInfo & info = trackerSubdet(k.subdet);
+  k.group = info.group;
+  k.barrel = info.isBarrel;
 
-		   (idetA == PixelSubdetector::PixelBarrel && idetB == PixelSubdetector::PixelBarrel) ||
-		   (idetA == PixelSubdetector::PixelEndcap && idetB == PixelSubdetector::PixelEndcap) ||
-		   (idetA == PixelSubdetector::PixelBarrel && idetB == PixelSubdetector::PixelEndcap) ||
-		   (idetA == PixelSubdetector::PixelEndcap && idetB == PixelSubdetector::PixelBarrel) );
+  if (k.group == 0) {
+    k.perp = k.absZ = 0;
+    return k;
+  }
+  GlobalPoint pos = geometry->idToDet(id)->surface().toGlobal(hit.localPosition());
+  k.perp = static_cast<unsigned int>(pos.perp() * 1E7);
+  k.absZ = static_cast<unsigned int>(std::abs(pos.z()) * 1E7);
+  return k;
+}
 
-  if (!same_det) return (idetA < idetB);
+bool TrackingRecHitLessFromGlobalPosition::insideOutLess( const TrackingRecHit& a, const TrackingRecHit& b) const{
 
-  if( (idetA == StripSubdetector::TIB || idetA == StripSubdetector::TOB || idetA == PixelSubdetector::PixelBarrel) &&
-      (idetB == StripSubdetector::TIB || idetB == StripSubdetector::TOB || idetB == PixelSubdetector::PixelBarrel)) {  
-    return  static_cast<unsigned int>(geometry->idToDet(ida)->surface().toGlobal(a.localPosition()).perp() * 1E7) < static_cast<unsigned int>(geometry->idToDet(idb)->surface().toGlobal(b.localPosition()).perp() * 1E7);
-  }
-  
-  if( (idetA == StripSubdetector::TEC || idetA == StripSubdetector::TID || idetA == PixelSubdetector::PixelEndcap) &&
-      (idetB == StripSubdetector::TEC || idetB == StripSubdetector::TID || idetB == PixelSubdetector::PixelEndcap)) {  
-    return static_cast<unsigned int>(std::abs(geometry->idToDet(ida)->surface().toGlobal(a.localPosition()).z()) * 1E7) < static_cast<unsigned int>(std::abs(geometry->idToDet(idb)->surface().toGlobal(b.localPosition()).z()) * 1E7);
-  }
+  unsigned int subdetA = static_cast<unsigned int>(a.geographicalId().subdetId());
+  unsigned int subdetB = static_cast<unsigned int>(b.geographicalId().subdetId());
+  unsigned int group = trackerSubdet(subdetA).group;
+  if (group == 0 || group != trackerSubdet(subdetB).group) return (subdetA < subdetB);
+
+  return insideOutLess( key(a), key(b));
+}
+
+bool TrackingRecHitLessFromGlobalPosition::insideOutLess( const Key& a, const Key& b){
+
+  if (a.group == 0 || a.group != b.group) return (a.subdet < b.subdet);
+
+  if (a.barrel && b.barrel) return a.perp < b.perp;
+
+  if (!a.barrel && !b.barrel) return a.absZ < b.absZ;
   
   //
   //  here I have 1 barrel against one forward
+  //  for the moment sort again in z, but since the z in the barrel is wrong (it is in the centre of the module)
+  //  add the semi length
   //
-  
-  if( (idetA == StripSubdetector::TIB || idetA == StripSubdetector::TOB || idetA == PixelSubdetector::PixelBarrel) &&
-      (idetB == StripSubdetector::TEC || idetB == StripSubdetector::TID || idetB == PixelSubdetector::PixelEndcap)) {
-    return barrelForwardLess( a, b);
-  }else{
-    return !barrelForwardLess( b, a);
-  }
-  
-  throw cms::Exception("TrackingRecHitLessFromGlobalPosition", "Arguments are not Ok");
+  if (a.barrel) return a.absZ < b.absZ;
+  else return !(b.absZ < a.absZ);
 }
 
-bool TrackingRecHitLessFromGlobalPosition::barrelForwardLess(  const TrackingRecHit& a, const TrackingRecHit& b) const{
-  //
-  // for the moment sort again in z, but since the z in the barrel is wrong (it is in the centre of the module)
-  // add the semi length
-  //
-  DetId ida(a.geographicalId());
-  DetId idb(b.geographicalId());
-  return  static_cast<unsigned int>(std::abs( geometry->idToDet(ida)->surface().toGlobal(a.localPosition()).z()) * 1E7) < static_cast<unsigned int>(std::abs( geometry->idToDet(idb)->surface().toGlobal(b.localPosition()).z()) * 1E7);
+void TrackingRecHitLessFromGlobalPosition::sort( edm::OwnVector<TrackingRecHit>& hits) const{
+  sortHitsByKey<Key>(hits, [this](const TrackingRecHit& hit) { return key(hit); }, *this);
 }
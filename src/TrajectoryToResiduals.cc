@@ -19,12 +19,15 @@ reco::TrackResiduals trajectoryToResiduals (const Trajectory &trajectory,
      Trajectory::DataContainer::const_reverse_iterator i_rend = 
 	  trajectory.measurements().rend(); 
      bool forward = trajectory.direction() == alongMomentum;
+     // stateless: shared by all the measurements
+     TrajectoryStateCombiner combine;
+     HelpertRecHit2DLocalPos helper;
      for (; forward ? i_fwd != i_end : i_bwd != i_rend; 
 	  ++i_fwd, ++i_bwd, ++i_residual) {
 	  const TrajectoryMeasurement *i = forward ? &*i_fwd : &*i_bwd;
-	  if (!i->recHit()->isValid()||i->recHit()->det()==0) 
+	  const TransientTrackingRecHit & hit = i->recHitR();
+	  if (!hit.isValid()||hit.det()==0) 
 	       continue;
-	  TrajectoryStateCombiner combine;
 	  if (!i->forwardPredictedState().isValid() || !i->backwardPredictedState().isValid())
 	    {
 	      edm::LogError("InvalideState")<<"one of the step is invalid";
@@ -41,11 +44,10 @@ reco::TrackResiduals trajectoryToResiduals (const Trajectory &trajectory,
 
 	  LocalPoint combo_localpos = combo.localPosition();
 	  LocalError combo_localerr = combo.localError().positionError();
-	  LocalPoint dethit_localpos = i->recHit()->localPosition();     
-	  LocalError dethit_localerr = i->recHit()->localPositionError();
-	  HelpertRecHit2DLocalPos helper;
+	  LocalPoint dethit_localpos = hit.localPosition();     
+	  LocalError dethit_localerr = hit.localPositionError();
 	  AlgebraicSymMatrix error_including_alignment = 
-	       helper.parError(dethit_localerr, *i->recHit()->det());
+	       helper.parError(dethit_localerr, *hit.det());
 	  switch (type) {
 	  case reco::TrackResiduals::X_Y_RESIDUALS: 
 	  {
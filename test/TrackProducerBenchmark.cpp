@@ -0,0 +1,467 @@
+// -*- C++ -*-
+//
+// Standalone benchmark of TrackProducerAlgorithm<reco::Track>:
+//  path=candidate   runWithCandidate on a TrackCandidateCollection (hit building with the
+//                   optional hit cache, candidate order and time budget, fit, track building)
+//  path=buildTrack  buildTrack only, on transient hits built beforehand
+//  path=hitSort     TrackingRecHitLessFromGlobalPosition::sort of the candidate hits given outside-in,
+//                   against OwnVector::sort with the same ordering
+//
+// Helices are generated in a uniform field through a synthetic tracker made of
+// flat barrel modules and endcap disks. A minimal TrackingGeometry and TransientTrackingRecHitBuilder
+// over these planes stand in for the tracker geometry and the CPEs: the persistent hits are smeared
+// local positions, built into 2D position constraint hits.
+// Loopers are generated over a full turn: their hits include the returning arc.
+// A fraction of the candidates are duplicates of another candidate of the event (same hits),
+// as in the pattern recognition output.
+//
+// usage: TrackProducerBenchmark [key=value ...]
+//   events=100 tracks=500 hits=12 looperFraction=0.05 duplicateFraction=0.2 seed=1
+//   path=candidate cacheTransientHits=0 candidateOrder= maxFitTimePerEvent=0
+//
+
+#include "RecoTracker/TrackProducer/interface/TrackProducerAlgorithm.h"
+#include "RecoTracker/TrackProducer/interface/TrackProducerProfiler.h"
+#include "RecoTracker/TrackProducer/interface/TrackingRecHitLessFromGlobalPosition.h"
+#include "RecoTracker/TransientTrackingRecHit/interface/TRecHit2DPosConstraint.h"
+
+#include "DataFormats/BeamSpot/interface/BeamSpot.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/GeometrySurface/interface/Plane.h"
+#include "DataFormats/TrackCandidate/interface/TrackCandidate.h"
+#include "DataFormats/TrackCandidate/interface/TrackCandidateCollection.h"
+#include "DataFormats/TrackingRecHit/interface/RecHit2DLocalPos.h"
+#include "DataFormats/TrajectorySeed/interface/TrajectorySeed.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "Geometry/CommonDetUnit/interface/GeomDet.h"
+#include "Geometry/CommonDetUnit/interface/TrackingGeometry.h"
+#include "MagneticField/Engine/interface/MagneticField.h"
+#include "TrackingTools/GeomPropagators/interface/AnalyticalPropagator.h"
+#include "TrackingTools/KalmanUpdators/interface/KFUpdator.h"
+#include "TrackingTools/KalmanUpdators/interface/Chi2MeasurementEstimator.h"
+#include "TrackingTools/TrackFitters/interface/KFTrajectoryFitter.h"
+#include "TrackingTools/TrackFitters/interface/KFTrajectorySmoother.h"
+#include "TrackingTools/TrackFitters/interface/KFFittingSmoother.h"
+#include "TrackingTools/TrajectoryParametrization/interface/GlobalTrajectoryParameters.h"
+#include "TrackingTools/TrajectoryParametrization/interface/CurvilinearTrajectoryError.h"
+#include "TrackingTools/TrajectoryState/interface/TrajectoryStateOnSurface.h"
+#include "TrackingTools/TrajectoryState/interface/TrajectoryStateTransform.h"
+#include "TrackingTools/TransientTrackingRecHit/interface/TransientTrackingRecHitBuilder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  const double bField = 3.8;          // T
+  const double kappa  = 0.0029979;    // GeV/(T cm)
+
+  class UniformField : public MagneticField {
+  public:
+    explicit UniformField(double bz) : field_(0,0,bz) {}
+    virtual GlobalVector inTesla(const GlobalPoint&) const { return field_; }
+    virtual MagneticField* clone() const { return new UniformField(*this); }
+  private:
+    GlobalVector field_;
+  };
+
+  struct BarrelLayer { double radius, halfLength; int nPhi; double sigma; };
+  struct Disk { double z, rMin, rMax; double sigma; };
+
+  // roughly the CMS tracker layout (cm)
+  const BarrelLayer barrelLayers[] = {
+    {4.4,26.7,20,0.002}, {7.3,26.7,32,0.002}, {10.2,26.7,44,0.002},
+    {25.5,70.,40,0.003}, {33.9,70.,52,0.003}, {41.8,70.,64,0.004}, {49.8,70.,76,0.004},
+    {60.8,110.,84,0.005}, {69.2,110.,96,0.005}, {78.0,110.,108,0.005},
+    {86.8,110.,120,0.005}, {96.5,110.,132,0.005}, {108.0,110.,148,0.005}
+  };
+  const Disk disks[] = {
+    {34.5,4.8,16.,0.002}, {46.5,4.8,16.,0.002},
+    {77.,23.,51.,0.004}, {90.,23.,51.,0.004}, {103.,23.,51.,0.004},
+    {124.,23.,110.,0.005}, {140.,23.,110.,0.005}, {157.,23.,110.,0.005}, {175.,23.,110.,0.005},
+    {196.,23.,110.,0.005}, {222.,23.,110.,0.005}, {250.,23.,110.,0.005}, {280.,23.,110.,0.005}
+  };
+  const unsigned int nBarrelLayers = sizeof(barrelLayers)/sizeof(BarrelLayer);
+  const unsigned int nDisks = sizeof(disks)/sizeof(Disk);
+
+  /// one module of the synthetic detector
+  class SyntheticDet : public GeomDet {
+  public:
+    SyntheticDet(const Plane::PlanePointer& plane, DetId id) : GeomDet(plane) { setDetId(id); }
+    virtual std::vector<const GeomDet*> components() const { return std::vector<const GeomDet*>(); }
+  };
+
+  /// the synthetic detector: one module per barrel phi sector and per disk side
+  class Detector : public TrackingGeometry {
+  public:
+    Detector() {
+      for (unsigned int l=0; l!=nBarrelLayers; ++l) {
+	const BarrelLayer & layer = barrelLayers[l];
+	std::vector<const GeomDet*> modules;
+	for (int k=0; k!=layer.nPhi; ++k) {
+	  double phi = 2*M_PI*k/layer.nPhi;
+	  double c = std::cos(phi), s = std::sin(phi);
+	  // local x along phi, local y along z, local z pointing outwards
+	  Surface::RotationType rot(-s, c, 0,  0, 0, 1,  c, s, 0);
+	  modules.push_back(add(Plane::build(Surface::PositionType(layer.radius*c,layer.radius*s,0),rot),1));
+	}
+	barrel_.push_back(modules);
+      }
+      for (unsigned int d=0; d!=nDisks; ++d) {
+	endcap_.push_back(add(Plane::build(Surface::PositionType(0,0, disks[d].z),Surface::RotationType()),2));
+	endcap_.push_back(add(Plane::build(Surface::PositionType(0,0,-disks[d].z),Surface::RotationType()),2));
+      }
+    }
+    ~Detector() {
+      for (DetContainer::const_iterator d=dets_.begin(); d!=dets_.end(); ++d) delete *d;
+    }
+
+    const GeomDet & module(unsigned int layer, int k) const { return *barrel_[layer][k]; }
+    const GeomDet & disk(unsigned int d, bool forward) const { return *endcap_[2*d+(forward ? 0 : 1)]; }
+
+    virtual const DetTypeContainer& detTypes() const { return detTypes_; }
+    virtual const DetUnitContainer& detUnits() const { return detUnits_; }
+    virtual const DetContainer& dets() const { return dets_; }
+    virtual const DetIdContainer& detUnitIds() const { return detUnitIds_; }
+    virtual const DetIdContainer& detIds() const { return detIds_; }
+    virtual const GeomDetUnit* idToDetUnit(DetId) const { return 0; }
+    virtual const GeomDet* idToDet(DetId id) const {
+      std::unordered_map<unsigned int,const GeomDet*>::const_iterator d = map_.find(id.rawId());
+      return d==map_.end() ? 0 : d->second;
+    }
+
+  private:
+    const GeomDet * add(const Plane::PlanePointer& plane, int subdet) {
+      DetId id(DetId(DetId::Tracker,subdet).rawId() | dets_.size());
+      const GeomDet * det = new SyntheticDet(plane,id);
+      dets_.push_back(det);
+      detIds_.push_back(id);
+      map_[id.rawId()] = det;
+      return det;
+    }
+
+    std::vector<std::vector<const GeomDet*> > barrel_;
+    std::vector<const GeomDet*> endcap_;
+    DetTypeContainer detTypes_;
+    DetUnitContainer detUnits_;
+    DetContainer dets_;
+    DetIdContainer detUnitIds_;
+    DetIdContainer detIds_;
+    std::unordered_map<unsigned int,const GeomDet*> map_;
+  };
+
+  /// persistent hit: smeared local position on a module; the cluster index identifies the physical hit
+  class SyntheticHit : public RecHit2DLocalPos {
+  public:
+    SyntheticHit(DetId id, const LocalPoint& pos, const LocalError& err, unsigned int cluster) :
+      RecHit2DLocalPos(id), pos_(pos), err_(err), cluster_(cluster) {}
+    virtual SyntheticHit * clone() const { return new SyntheticHit(*this); }
+    virtual LocalPoint localPosition() const { return pos_; }
+    virtual LocalError localPositionError() const { return err_; }
+    virtual bool sharesInput(const TrackingRecHit* other, SharedInputType) const {
+      const SyntheticHit * hit = dynamic_cast<const SyntheticHit*>(other);
+      return hit && hit->geographicalId()==geographicalId() && hit->cluster_==cluster_;
+    }
+  private:
+    LocalPoint pos_;
+    LocalError err_;
+    unsigned int cluster_;
+  };
+
+  /// stands in for the CPE: the transient hit is a 2D position constraint on the module
+  class SyntheticHitBuilder : public TransientTrackingRecHitBuilder {
+  public:
+    explicit SyntheticHitBuilder(const TrackingGeometry & geometry) : geometry_(geometry) {}
+    virtual TransientTrackingRecHit::RecHitPointer build(const TrackingRecHit * hit) const {
+      return TRecHit2DPosConstraint::build(hit->localPosition(),hit->localPositionError(),
+					   &geometry_.idToDet(hit->geographicalId())->surface());
+    }
+  private:
+    const TrackingGeometry & geometry_;
+  };
+
+  /// helix in a uniform field along z, parametrised by the transverse path length t
+  struct Helix {
+    double x0, y0, z0, pt, phi0, cotTheta, omega;
+    int charge;
+    double phi(double t) const { return phi0+omega*t; }
+    GlobalPoint position(double t) const {
+      return GlobalPoint(x0+(std::sin(phi(t))-std::sin(phi0))/omega,
+			 y0-(std::cos(phi(t))-std::cos(phi0))/omega,
+			 z0+t*cotTheta);
+    }
+    GlobalVector momentum(double t) const {
+      return GlobalVector(pt*std::cos(phi(t)),pt*std::sin(phi(t)),pt*cotTheta);
+    }
+    /// path length of one turn
+    double turn() const { return 2*M_PI/std::abs(omega); }
+    /// path length to the plane, by Newton iterations from t (negative if it does not converge)
+    double toPlane(const Plane & plane, double t) const {
+      GlobalVector n = plane.normalVector();
+      for (int i=0; i!=20; ++i) {
+	double f = (position(t)-plane.position()).dot(n);
+	if (std::abs(f)<1e-7) return t;
+	double df = std::cos(phi(t))*n.x()+std::sin(phi(t))*n.y()+cotTheta*n.z();
+	if (std::abs(df)<1e-9) return -1;
+	t -= f/df;
+      }
+      return -1;
+    }
+  };
+
+  struct Crossing { double t; const GeomDet * det; double sigma; };
+
+  struct Candidate {
+    std::vector<SyntheticHit> hits;
+    TrajectoryStateOnSurface state;
+    DetId firstDet;
+    signed char nLoops;
+  };
+
+  class Generator {
+  public:
+    Generator(const Detector & det, const MagneticField * field, unsigned int seed) :
+      det_(det), field_(field), rnd_(seed), nClusters_(0) {}
+
+    /// false if the helix does not cross at least three layers.
+    /// A looper is followed over a full turn (outgoing and returning arcs), the others over half a turn.
+    bool generate(bool looper, unsigned int nHits, Candidate & cand) {
+      std::uniform_real_distribution<double> flat(0.,1.);
+      std::normal_distribution<double> gauss(0.,1.);
+      Helix h;
+      h.x0 = 0.0015*gauss(rnd_); h.y0 = 0.0015*gauss(rnd_); h.z0 = 5.*gauss(rnd_);
+      h.pt = looper ? 0.1+0.2*flat(rnd_) : 0.5*std::pow(100.,flat(rnd_));
+      h.phi0 = 2*M_PI*flat(rnd_);
+      h.cotTheta = looper ? std::sinh(0.6*flat(rnd_)-0.3) : std::sinh(5.*flat(rnd_)-2.5);
+      h.charge = flat(rnd_)<0.5 ? -1 : 1;
+      h.omega = -h.charge*kappa*bField/h.pt;
+      double maxT = looper ? h.turn() : 0.5*h.turn();
+
+      std::vector<Crossing> crossings;
+      double rho = 1./std::abs(h.omega);
+      for (unsigned int l=0; l!=nBarrelLayers; ++l) {
+	const BarrelLayer & layer = barrelLayers[l];
+	if (layer.radius>=2*rho) break;
+	double tOut = 2*rho*std::asin(layer.radius/(2*rho));
+	// the returning arc crosses the layer again, symmetrically to the outgoing crossing
+	double tArcs[2] = { tOut, h.turn()-tOut };
+	for (unsigned int a=0; a!=(looper ? 2U : 1U); ++a) {
+	  double phi = h.position(tArcs[a]).phi();
+	  int k = int(std::floor(phi/(2*M_PI)*layer.nPhi+0.5));
+	  k = ((k%layer.nPhi)+layer.nPhi)%layer.nPhi;
+	  const GeomDet & det = det_.module(l,k);
+	  double t = h.toPlane(det.surface(),tArcs[a]);
+	  if (t<=0 || t>maxT || std::abs(h.position(t).z())>layer.halfLength) continue;
+	  Crossing c = { t, &det, layer.sigma };
+	  crossings.push_back(c);
+	}
+      }
+      for (unsigned int d=0; d!=nDisks && h.cotTheta!=0; ++d) {
+	bool forward = h.cotTheta>0;
+	double t = ((forward ? disks[d].z : -disks[d].z)-h.z0)/h.cotTheta;
+	if (t<=0 || t>maxT) continue;
+	double r = h.position(t).perp();
+	if (r<disks[d].rMin || r>disks[d].rMax) continue;
+	Crossing c = { t, &det_.disk(d,forward), disks[d].sigma };
+	crossings.push_back(c);
+      }
+      if (crossings.size()<3) return false;
+      std::sort(crossings.begin(),crossings.end(),[](const Crossing& a, const Crossing& b){ return a.t<b.t; });
+      if (crossings.size()>nHits) crossings.resize(nHits);
+
+      cand.hits.clear();
+      for (std::vector<Crossing>::const_iterator c=crossings.begin(); c!=crossings.end(); ++c) {
+	LocalPoint lp = c->det->surface().toLocal(h.position(c->t));
+	LocalPoint measured(lp.x()+c->sigma*gauss(rnd_),lp.y()+c->sigma*gauss(rnd_),0);
+	LocalError err(c->sigma*c->sigma,0,c->sigma*c->sigma);
+	cand.hits.push_back(SyntheticHit(c->det->geographicalId(),measured,err,nClusters_++));
+      }
+
+      // true state on the first surface with large errors, as for a refit
+      const Crossing & first = crossings.front();
+      GlobalTrajectoryParameters gtp(h.position(first.t),h.momentum(first.t),h.charge,field_);
+      AlgebraicSymMatrix55 cov;
+      double p = h.momentum(first.t).mag();
+      cov(0,0) = 0.01/(p*p); cov(1,1) = 1e-4; cov(2,2) = 1e-4; cov(3,3) = 0.01; cov(4,4) = 0.01;
+      cand.state = TrajectoryStateOnSurface(gtp,CurvilinearTrajectoryError(cov),first.det->surface());
+      cand.state.rescaleError(100);
+      cand.firstDet = first.det->geographicalId();
+      // the returning arc is only reached if the last hit is beyond half a turn
+      cand.nLoops = (looper && crossings.back().t>0.5*h.turn()) ? 1 : 0;
+      return true;
+    }
+
+  private:
+    const Detector & det_;
+    const MagneticField * field_;
+    std::mt19937 rnd_;
+    unsigned int nClusters_;
+  };
+
+  /// key=value command line arguments
+  class Arguments {
+  public:
+    Arguments(int argc, char** argv) {
+      for (int i=1; i<argc; ++i) {
+	std::string arg(argv[i]);
+	std::string::size_type eq = arg.find('=');
+	if (eq==std::string::npos) std::cerr << "ignoring argument " << arg << " (not key=value)\n";
+	else values_[arg.substr(0,eq)] = arg.substr(eq+1);
+      }
+    }
+    std::string get(const std::string& key, const std::string& def) const {
+      std::map<std::string,std::string>::const_iterator v = values_.find(key);
+      return v==values_.end() ? def : v->second;
+    }
+    double get(const std::string& key, double def) const {
+      std::map<std::string,std::string>::const_iterator v = values_.find(key);
+      return v==values_.end() ? def : std::atof(v->second.c_str());
+    }
+  private:
+    std::map<std::string,std::string> values_;
+  };
+
+}
+
+int main(int argc, char** argv) {
+  Arguments args(argc,argv);
+  unsigned int nEvents = args.get("events",100.);
+  unsigned int nTracks = args.get("tracks",500.);
+  unsigned int nHits   = args.get("hits",12.);
+  double looperFraction = args.get("looperFraction",0.05);
+  double duplicateFraction = args.get("duplicateFraction",0.2);
+  unsigned int seed    = args.get("seed",1.);
+  std::string path     = args.get("path",std::string("candidate"));
+  if (path!="candidate" && path!="buildTrack" && path!="hitSort") {
+    std::cerr << "unknown path " << path << ": use candidate, buildTrack or hitSort\n";
+    return 1;
+  }
+
+  UniformField field(bField);
+  Detector detector;
+  SyntheticHitBuilder hitBuilder(detector);
+  Generator generator(detector,&field,seed);
+  std::mt19937 rnd(seed+1);
+  std::uniform_real_distribution<double> flat(0.,1.);
+
+  AnalyticalPropagator propagator(&field,alongMomentum);
+  AnalyticalPropagator backPropagator(&field,oppositeToMomentum);
+  KFUpdator updator;
+  Chi2MeasurementEstimator estimator(30.,3.);
+  KFFittingSmoother fitter(KFTrajectoryFitter(propagator,updator,estimator),
+			   KFTrajectorySmoother(backPropagator,updator,estimator));
+
+  reco::BeamSpot::CovarianceMatrix bsError;
+  for (int i=0; i!=reco::BeamSpot::dimension; ++i) bsError(i,i) = 1e-6;
+  reco::BeamSpot beamSpot(reco::BeamSpot::Point(0,0,0),5.,0.,0.,0.0015,bsError);
+
+  edm::ParameterSet conf;
+  conf.addParameter<std::string>("AlgorithmName","undefAlgorithm");
+  conf.addParameter<bool>("cacheTransientHits",args.get("cacheTransientHits",0.)!=0);
+  conf.addParameter<std::string>("candidateOrder",args.get("candidateOrder",std::string("")));
+  conf.addParameter<double>("maxFitTimePerEvent",args.get("maxFitTimePerEvent",0.));
+  TrackProducerAlgorithm<reco::Track> algo(conf);
+  TrackProducerProfiler profiler;
+  profiler.setEnabled(true);
+  profiler.setLabel("TrackProducerBenchmark");
+  algo.setProfiler(&profiler);
+
+  TrajectorySeed trajectorySeed(PTrajectoryStateOnDet(),TrajectorySeed::recHitContainer(),alongMomentum);
+
+  unsigned long long nCandidates = 0, nBuilt = 0, nSkipped = 0;
+  std::chrono::steady_clock::duration total(0), slowest(0), referenceSort(0);
+  TrackingRecHitLessFromGlobalPosition hitLess(&detector,alongMomentum);
+  std::vector<edm::OwnVector<TrackingRecHit> > hitsToSort(nTracks), referenceHits(nTracks);
+  std::vector<Candidate> candidates(nTracks);
+  std::vector<TransientTrackingRecHit::RecHitContainer> transientHits(nTracks);
+  TrackCandidateCollection trackCandidates;
+  TrackProducerAlgorithm<reco::Track>::AlgoProductCollection products;
+  for (unsigned int ev=0; ev!=nEvents; ++ev) {
+    // generation and input preparation are not timed
+    for (unsigned int i=0; i!=nTracks; ++i) {
+      if (i>0 && flat(rnd)<duplicateFraction) {
+	candidates[i] = candidates[std::uniform_int_distribution<unsigned int>(0,i-1)(rnd)];
+	continue;
+      }
+      bool looper = flat(rnd)<looperFraction;
+      while (!generator.generate(looper,nHits,candidates[i])) {}
+    }
+    if (path=="candidate") {
+      trackCandidates.clear();
+      trackCandidates.reserve(nTracks);
+      for (unsigned int i=0; i!=nTracks; ++i) {
+	const Candidate & cand = candidates[i];
+	TrackCandidate::RecHitContainer hits;
+	for (std::vector<SyntheticHit>::const_iterator h=cand.hits.begin(); h!=cand.hits.end(); ++h) {
+	  TrackingRecHit * hit = h->clone();
+	  hits.push_back(hit);
+	}
+	trackCandidates.push_back(TrackCandidate(hits,trajectorySeed,
+						 trajectoryStateTransform::persistentState(cand.state,cand.firstDet.rawId()),
+						 cand.nLoops));
+      }
+    } else if (path=="hitSort") {
+      for (unsigned int i=0; i!=nTracks; ++i) {
+	hitsToSort[i].clear();
+	for (std::vector<SyntheticHit>::const_reverse_iterator h=candidates[i].hits.rbegin(); h!=candidates[i].hits.rend(); ++h) {
+	  TrackingRecHit * hit = h->clone();
+	  hitsToSort[i].push_back(hit);
+	}
+	referenceHits[i] = hitsToSort[i];
+      }
+      std::chrono::steady_clock::time_point referenceStart = std::chrono::steady_clock::now();
+      for (unsigned int i=0; i!=nTracks; ++i) referenceHits[i].sort(hitLess);
+      referenceSort += std::chrono::steady_clock::now()-referenceStart;
+    } else {
+      for (unsigned int i=0; i!=nTracks; ++i) {
+	transientHits[i].clear();
+	for (std::vector<SyntheticHit>::const_iterator h=candidates[i].hits.begin(); h!=candidates[i].hits.end(); ++h)
+	  transientHits[i].push_back(hitBuilder.build(&*h));
+      }
+    }
+
+    products.clear();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (path=="candidate") {
+      nSkipped += algo.runWithCandidate(&detector,&field,trackCandidates,&fitter,&propagator,&hitBuilder,beamSpot,products);
+    } else if (path=="hitSort") {
+      for (unsigned int i=0; i!=nTracks; ++i) hitLess.sort(hitsToSort[i]);
+    } else {
+      products.reserve(nTracks);
+      for (unsigned int i=0; i!=nTracks; ++i) {
+	Candidate & cand = candidates[i];
+	float ndof = 0;
+	algo.buildTrack(&fitter,&propagator,products,transientHits[i],cand.state,trajectorySeed,ndof,beamSpot,
+			reco::TrackBase::undefAlgorithm,TrackProducerAlgorithm<reco::Track>::SeedRef(),0,cand.nLoops);
+      }
+    }
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now()-start;
+    total += elapsed;
+    slowest = std::max(slowest,elapsed);
+    nCandidates += nTracks;
+    nBuilt += products.size();
+  }
+
+  double seconds = std::chrono::duration<double>(total).count();
+  std::cout << "path=" << path << " events=" << nEvents << " candidates/event=" << nTracks << " hits/track=" << nHits
+	    << " looperFraction=" << looperFraction << " duplicateFraction=" << duplicateFraction << "\n"
+	    << "tracks_built=" << nBuilt << "/" << nCandidates << " candidates_skipped=" << nSkipped
+	    << " total_s=" << seconds
+	    << " us/track=" << (nCandidates ? 1e6*seconds/nCandidates : 0.)
+	    << " events/s=" << (seconds>0 ? nEvents/seconds : 0.)
+	    << " slowest_event_ms=" << 1e3*std::chrono::duration<double>(slowest).count() << "\n";
+  if (path=="hitSort")
+    std::cout << "OwnVector::sort_s=" << std::chrono::duration<double>(referenceSort).count()
+	      << " us/track=" << (nCandidates ? 1e6*std::chrono::duration<double>(referenceSort).count()/nCandidates : 0.) << "\n";
+  else
+    profiler.print(std::cout);
+  return 0;
+}
@@ -0,0 +1,278 @@
+// -*- C++ -*-
+//
+// Unit test of TrackingRecHitLessFromGlobalPosition against the comparison it replaced
+// (hit by hit, with the positions recomputed at every call):
+//  - operator() on hits and on precomputed keys give the reference result for every pair of hits;
+//  - sort() puts the hits of straight tracks in the same order as OwnVector::sort with the
+//    reference comparison;
+//  - sort() moves the pointers only: the sorted OwnVector holds the same hit objects.
+// The hits live on a synthetic detector with one plane per module and real tracker subdetector ids.
+//
+
+#include "RecoTracker/TrackProducer/interface/TrackingRecHitLessFromGlobalPosition.h"
+
+#include "DataFormats/Common/interface/OwnVector.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/GeometrySurface/interface/Plane.h"
+#include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
+#include "DataFormats/SiStripDetId/interface/StripSubdetector.h"
+#include "DataFormats/TrackingRecHit/interface/RecHit2DLocalPos.h"
+#include "Geometry/CommonDetUnit/interface/GeomDet.h"
+#include "Geometry/CommonDetUnit/interface/TrackingGeometry.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  class SyntheticDet : public GeomDet {
+  public:
+    SyntheticDet(const Plane::PlanePointer& plane, DetId id) : GeomDet(plane) { setDetId(id); }
+    virtual std::vector<const GeomDet*> components() const { return std::vector<const GeomDet*>(); }
+  };
+
+  /// modules are added on demand: a barrel module facing phi at radius r, or a disk at z
+  class Detector : public TrackingGeometry {
+  public:
+    ~Detector() {
+      for (DetContainer::const_iterator d=dets_.begin(); d!=dets_.end(); ++d) delete *d;
+    }
+    DetId barrelModule(int subdet, double r, double phi) {
+      double c = std::cos(phi), s = std::sin(phi);
+      Surface::RotationType rot(-s, c, 0,  0, 0, 1,  c, s, 0);
+      return add(Plane::build(Surface::PositionType(r*c,r*s,0),rot),subdet);
+    }
+    DetId disk(int subdet, double z) {
+      return add(Plane::build(Surface::PositionType(0,0,z),Surface::RotationType()),subdet);
+    }
+
+    virtual const DetTypeContainer& detTypes() const { return detTypes_; }
+    virtual const DetUnitContainer& detUnits() const { return detUnits_; }
+    virtual const DetContainer& dets() const { return dets_; }
+    virtual const DetIdContainer& detUnitIds() const { return detUnitIds_; }
+    virtual const DetIdContainer& detIds() const { return detIds_; }
+    virtual const GeomDetUnit* idToDetUnit(DetId) const { return 0; }
+    virtual const GeomDet* idToDet(DetId id) const {
+      std::unordered_map<unsigned int,const GeomDet*>::const_iterator d = map_.find(id.rawId());
+      return d==map_.end() ? 0 : d->second;
+    }
+
+  private:
+    DetId add(const Plane::PlanePointer& plane, int subdet) {
+      DetId id(DetId(DetId::Tracker,subdet).rawId() | dets_.size());
+      const GeomDet * det = new SyntheticDet(plane,id);
+      dets_.push_back(det);
+      detIds_.push_back(id);
+      map_[id.rawId()] = det;
+      return id;
+    }
+
+    DetTypeContainer detTypes_;
+    DetUnitContainer detUnits_;
+    DetContainer dets_;
+    DetIdContainer detUnitIds_;
+    DetIdContainer detIds_;
+    std::unordered_map<unsigned int,const GeomDet*> map_;
+  };
+
+  class SyntheticHit : public RecHit2DLocalPos {
+  public:
+    SyntheticHit(DetId id, const LocalPoint& pos) : RecHit2DLocalPos(id), pos_(pos) {}
+    virtual SyntheticHit * clone() const { return new SyntheticHit(*this); }
+    virtual LocalPoint localPosition() const { return pos_; }
+    virtual LocalError localPositionError() const { return LocalError(1e-6,0,1e-6); }
+  private:
+    LocalPoint pos_;
+  };
+
+  /// the comparison as it was before the keys
+  class ReferenceLess {
+  public:
+    ReferenceLess(const TrackingGeometry * geometry, PropagationDirection dir) : geometry_(geometry), dir_(dir) {}
+    bool operator()(const TrackingRecHit& a, const TrackingRecHit& b) const {
+      return dir_==alongMomentum ? insideOutLess(a,b) : insideOutLess(b,a);
+    }
+  private:
+    static bool isBarrel(unsigned int id) {
+      return id==StripSubdetector::TIB || id==StripSubdetector::TOB || id==PixelSubdetector::PixelBarrel;
+    }
+    static bool isForward(unsigned int id) {
+      return id==StripSubdetector::TEC || id==StripSubdetector::TID || id==PixelSubdetector::PixelEndcap;
+    }
+    static bool sameDet(unsigned int a, unsigned int b) {
+      unsigned int groupA = (a==StripSubdetector::TIB || a==StripSubdetector::TID) ? 2 :
+	(a==StripSubdetector::TOB || a==StripSubdetector::TEC) ? 3 :
+	(a==PixelSubdetector::PixelBarrel || a==PixelSubdetector::PixelEndcap) ? 1 : 0;
+      unsigned int groupB = (b==StripSubdetector::TIB || b==StripSubdetector::TID) ? 2 :
+	(b==StripSubdetector::TOB || b==StripSubdetector::TEC) ? 3 :
+	(b==PixelSubdetector::PixelBarrel || b==PixelSubdetector::PixelEndcap) ? 1 : 0;
+      return groupA!=0 && groupA==groupB;
+    }
+    GlobalPoint position(const TrackingRecHit& hit) const {
+      return geometry_->idToDet(hit.geographicalId())->surface().toGlobal(hit.localPosition());
+    }
+    bool barrelForwardLess(const TrackingRecHit& a, const TrackingRecHit& b) const {
+      return static_cast<unsigned int>(std::abs(position(a).z()) * 1E7) <
+	static_cast<unsigned int>(std::abs(position(b).z()) * 1E7);
+    }
+    bool insideOutLess(const TrackingRecHit& a, const TrackingRecHit& b) const {
+      unsigned int idetA = static_cast<unsigned int>(a.geographicalId().subdetId());
+      unsigned int idetB = static_cast<unsigned int>(b.geographicalId().subdetId());
+      if (!sameDet(idetA,idetB)) return idetA < idetB;
+      if (isBarrel(idetA) && isBarrel(idetB))
+	return static_cast<unsigned int>(position(a).perp() * 1E7) < static_cast<unsigned int>(position(b).perp() * 1E7);
+      if (isForward(idetA) && isForward(idetB))
+	return barrelForwardLess(a,b);
+      if (isBarrel(idetA)) return barrelForwardLess(a,b);
+      else return !barrelForwardLess(b,a);
+    }
+    const TrackingGeometry * geometry_;
+    PropagationDirection dir_;
+  };
+
+  /// OwnVector::push_back takes the pointer by reference
+  void addHit(edm::OwnVector<TrackingRecHit> & hits, TrackingRecHit * hit) { hits.push_back(hit); }
+
+  const int barrelSubdets[] = { PixelSubdetector::PixelBarrel, StripSubdetector::TIB, StripSubdetector::TOB };
+  const int forwardSubdets[] = { PixelSubdetector::PixelEndcap, StripSubdetector::TID, StripSubdetector::TEC };
+  // per group: barrel layer radii and disk |z| (cm)
+  const double radii[3][4] = { {4.4,7.3,10.2,0}, {25.5,33.9,41.8,49.8}, {60.8,78.0,96.5,108.0} };
+  const double diskZ[3][3] = { {34.5,46.5,0}, {77.,90.,103.}, {124.,175.,250.} };
+
+  /// hits of a straight track from the origin (inside-out order), plus invalid hits without DetId
+  void straightTrack(Detector & det, std::mt19937 & rnd, edm::OwnVector<TrackingRecHit> & hits) {
+    std::uniform_real_distribution<double> flat(0.,1.);
+    double phi = 2*M_PI*flat(rnd), eta = 5.*flat(rnd)-2.5;
+    double theta = 2*std::atan(std::exp(-eta));
+    GlobalVector dir(std::sin(theta)*std::cos(phi),std::sin(theta)*std::sin(phi),std::cos(theta));
+    for (unsigned int g=0; g!=3; ++g) {
+      for (unsigned int l=0; l!=4 && radii[g][l]>0; ++l) {
+	double s = radii[g][l]/std::sin(theta);
+	if (std::abs(s*dir.z())>110.) continue;
+	DetId id = det.barrelModule(barrelSubdets[g],radii[g][l],phi+0.02*(flat(rnd)-0.5));
+	GlobalPoint p(s*dir.x(),s*dir.y(),s*dir.z());
+	addHit(hits,new SyntheticHit(id,det.idToDet(id)->surface().toLocal(p)));
+      }
+      if (std::abs(dir.z())<0.05) continue;
+      for (unsigned int d=0; d!=3 && diskZ[g][d]>0; ++d) {
+	double z = dir.z()>0 ? diskZ[g][d] : -diskZ[g][d];
+	double s = z/dir.z();
+	if (s*std::sin(theta)>110.) continue;
+	DetId id = det.disk(forwardSubdets[g],z);
+	GlobalPoint p(s*dir.x(),s*dir.y(),z);
+	addHit(hits,new SyntheticHit(id,det.idToDet(id)->surface().toLocal(p)));
+      }
+    }
+    if (flat(rnd)<0.5) addHit(hits,new SyntheticHit(DetId(),LocalPoint()));
+  }
+
+  bool sameOrder(const edm::OwnVector<TrackingRecHit> & a, const edm::OwnVector<TrackingRecHit> & b) {
+    if (a.size()!=b.size()) return false;
+    for (unsigned int i=0; i!=a.size(); ++i) {
+      if (a[i].geographicalId()!=b[i].geographicalId()) return false;
+      LocalPoint pa = a[i].localPosition(), pb = b[i].localPosition();
+      if (pa.x()!=pb.x() || pa.y()!=pb.y()) return false;
+    }
+    return true;
+  }
+
+}
+
+class TrackingRecHitSortTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TrackingRecHitSortTest);
+  CPPUNIT_TEST(checkComparison);
+  CPPUNIT_TEST(checkSort);
+  CPPUNIT_TEST(checkHitsKept);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() { rnd_.seed(1); }
+  void tearDown() {}
+  void checkComparison();
+  void checkSort();
+  void checkHitsKept();
+
+private:
+  /// the hits of a straight track in random order
+  void shuffledTrack(edm::OwnVector<TrackingRecHit> & shuffled) {
+    edm::OwnVector<TrackingRecHit> track;
+    straightTrack(det_,rnd_,track);
+    // shuffle through a copy (OwnVector has no swap of elements)
+    std::vector<unsigned int> perm(track.size());
+    for (unsigned int i=0; i!=perm.size(); ++i) perm[i]=i;
+    std::shuffle(perm.begin(),perm.end(),rnd_);
+    for (unsigned int i=0; i!=perm.size(); ++i) addHit(shuffled,track[perm[i]].clone());
+  }
+
+  Detector det_;
+  std::mt19937 rnd_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TrackingRecHitSortTest);
+
+namespace {
+  const PropagationDirection dirs[2] = { alongMomentum, oppositeToMomentum };
+}
+
+void TrackingRecHitSortTest::checkComparison() {
+  // every pair of hits spread over all the subdetectors
+  std::uniform_real_distribution<double> flat(0.,1.);
+  edm::OwnVector<TrackingRecHit> hits;
+  for (unsigned int i=0; i!=300; ++i) {
+    unsigned int g = std::uniform_int_distribution<unsigned int>(0,2)(rnd_);
+    DetId id = flat(rnd_)<0.5 ?
+      det_.barrelModule(barrelSubdets[g],radii[g][0]+100.*flat(rnd_),2*M_PI*flat(rnd_)) :
+      det_.disk(forwardSubdets[g],(flat(rnd_)<0.5 ? -1 : 1)*(diskZ[g][0]+200.*flat(rnd_)));
+    addHit(hits,new SyntheticHit(id,LocalPoint(10.*(flat(rnd_)-0.5),20.*(flat(rnd_)-0.5),0)));
+  }
+  addHit(hits,new SyntheticHit(DetId(),LocalPoint()));
+  for (unsigned int d=0; d!=2; ++d) {
+    TrackingRecHitLessFromGlobalPosition less(&det_,dirs[d]);
+    ReferenceLess reference(&det_,dirs[d]);
+    for (unsigned int i=0; i!=hits.size(); ++i) {
+      for (unsigned int j=0; j!=hits.size(); ++j) {
+	bool expected = reference(hits[i],hits[j]);
+	CPPUNIT_ASSERT_EQUAL(expected,less(hits[i],hits[j]));
+	CPPUNIT_ASSERT_EQUAL(expected,less(less.key(hits[i]),less.key(hits[j])));
+      }
+    }
+  }
+}
+
+void TrackingRecHitSortTest::checkSort() {
+  for (unsigned int t=0; t!=1000; ++t) {
+    edm::OwnVector<TrackingRecHit> shuffled;
+    shuffledTrack(shuffled);
+    for (unsigned int d=0; d!=2; ++d) {
+      edm::OwnVector<TrackingRecHit> expected(shuffled), sorted(shuffled);
+      expected.sort(ReferenceLess(&det_,dirs[d]));
+      TrackingRecHitLessFromGlobalPosition(&det_,dirs[d]).sort(sorted);
+      CPPUNIT_ASSERT(sameOrder(sorted,expected));
+    }
+  }
+}
+
+void TrackingRecHitSortTest::checkHitsKept() {
+  for (unsigned int t=0; t!=100; ++t) {
+    edm::OwnVector<TrackingRecHit> hits;
+    shuffledTrack(hits);
+    std::set<const TrackingRecHit*> before;
+    for (unsigned int i=0; i!=hits.size(); ++i) before.insert(&hits[i]);
+    TrackingRecHitLessFromGlobalPosition less(&det_,alongMomentum);
+    less.sort(hits);
+    std::set<const TrackingRecHit*> after;
+    for (unsigned int i=0; i!=hits.size(); ++i) after.insert(&hits[i]);
+    CPPUNIT_ASSERT(before==after);
+    // sorting again leaves every hit in place
+    std::vector<const TrackingRecHit*> sorted;
+    for (unsigned int i=0; i!=hits.size(); ++i) sorted.push_back(&hits[i]);
+    less.sort(hits);
+    for (unsigned int i=0; i!=hits.size(); ++i) CPPUNIT_ASSERT(&hits[i]==sorted[i]);
+  }
+}